@@ -41,10 +41,59 @@ class QuestionResponse:
         self.response = response
 
 class FrameInfo:
-    def __init__(self, time, sdt, idt):
+    def __init__(self, time, sdt, idt, rdt=0, userInput=0, simulation=0, pose=0, wait=0, graphics=0, overWait=0):
         self.time = time
         self.sdt = float(sdt)
         self.idt = float(idt)
+        self.rdt = float(rdt)
+        self.userInput = float(userInput)
+        self.simulation = float(simulation)
+        self.pose = float(pose)
+        self.wait = float(wait)
+        self.graphics = float(graphics)
+        self.overWait = float(overWait)
+
+class TrialStats:
+    def __init__(self, trialNumber, trialId, sessId, shots, hits, misses, kills, targetsHit, accuracy, hitsPerTarget, firstHitTime, firstKillTime, meanKillTime):
+        self.trialNumber = int(trialNumber)
+        self.trialId = int(trialId)
+        self.sessId = sessId
+        self.shots = int(shots)
+        self.hits = int(hits)
+        self.misses = int(misses)
+        self.kills = int(kills)
+        self.targetsHit = int(targetsHit)
+        self.accuracy = float(accuracy)
+        self.hitsPerTarget = float(hitsPerTarget)
+        # Times are in seconds from the start of the task (None if the event never happened)
+        self.firstHitTime = None if float(firstHitTime) < 0 else float(firstHitTime)
+        self.firstKillTime = None if float(firstKillTime) < 0 else float(firstKillTime)
+        self.meanKillTime = None if float(meanKillTime) < 0 else float(meanKillTime)
+
+class StateTransition:
+    def __init__(self, time, timelineNs, simTime, frame, trialId, fromState, toState):
+        self.time = time
+        self.timelineNs = int(timelineNs)
+        self.simTime = float(simTime)
+        self.frame = int(frame)
+        self.trialId = int(trialId)
+        self.fromState = fromState
+        self.toState = toState
+
+class AimError:
+    def __init__(self, time, targetCount, nearestTarget, nearestError, meanError):
+        self.time = time
+        self.targetCount = int(targetCount)
+        self.nearestTarget = nearestTarget
+        self.nearestError = float(nearestError)
+        self.meanError = float(meanError)
+
+class BakedKeyframe:
+    def __init__(self, spawnTime, targetId, t, x, y, z):
+        self.spawnTime = spawnTime
+        self.targetId = targetId
+        self.t = float(t)
+        self.position = [float(x), float(y), float(z)]
 
 class Event:
     def __init__(self, time, eventType):
@@ -221,9 +270,44 @@ class Importer:
         """Get the frame info table as a list"""
         frames = []
         for row in self.getTableRows('Frame_Info'):
-            frames.append(FrameInfo(row[0], row[2], row[1]))
+            # Columns: time, rdt, sdt, idt, user_input, simulation, pose, wait, graphics, over_wait
+            frames.append(FrameInfo(row[0], row[2], row[3], row[1], *row[4:10]))
         return frames
 
+    def getTrialStats(self):
+        """Get the per-trial statistics table as a list"""
+        return [TrialStats(*row[0:13]) for row in self.getTableRows('Trial_Stats')]
+
+    def getStateTimeline(self):
+        """Get the presentation state transitions as a list"""
+        # Columns: time, timeline_ns, sim_time, frame, trial_id, from_state, to_state
+        return [StateTransition(*row[0:7]) for row in self.getTableRows('State_Timeline')]
+
+    def getTaskDurations(self):
+        """Get (trial id, task duration in seconds) for each task state, from the state timeline"""
+        durations = []
+        start = None
+        for t in self.getStateTimeline():
+            if t.toState == 'task': start = t
+            elif t.fromState == 'task' and start is not None:
+                durations.append((start.trialId, (t.timelineNs - start.timelineNs) * 1e-9))
+                start = None
+        return durations
+
+    def getAimErrors(self):
+        """Get the per-frame aim error (in degrees) as a list"""
+        # Columns: time, target_count, nearest_target, nearest_error, mean_error
+        return [AimError(*row[0:5]) for row in self.getTableRows('Aim_Error')]
+
+    def getBakedTrajectories(self):
+        """Get the baked target paths as a dictionary of (spawn time, target id) to a list of keyframes"""
+        # Columns: spawn_time, target_id, t, position_x, position_y, position_z
+        paths = {}
+        for row in self.getTableRows('Baked_Trajectory'):
+            k = BakedKeyframe(*row[0:6])
+            paths.setdefault((k.spawnTime, k.targetId), []).append(k)
+        return paths
+
     def parseTime(self, timeStr):
         return datetime.strptime(timeStr, IN_LOG_TIME_FORMAT)
         
@@ -0,0 +1,71 @@
+import sys
+import time
+import socket
+import struct
+
+# Listens for the live telemetry published when "telemetryEnable" is set and prints rolling statistics
+# Usage: python telemetry_monitor.py [port] [window (s)]
+
+port = 19550
+if len(sys.argv) > 1: port = int(sys.argv[1])
+window = 1.0
+if len(sys.argv) > 2: window = float(sys.argv[2])
+
+# Message layouts (must match Telemetry.h)
+HEADER = struct.Struct('<HBBIQ')        # magic, version, type, sequence, time
+FRAME = struct.Struct('<fffI')          # rdt, sdt, idt, logger queue bytes
+ACTION = struct.Struct('<Bff')          # action, az, el
+TRIAL = struct.Struct('<ifii')          # trial index, task time, destroyed, total
+MAGIC = 0x5446
+TYPE_FRAME, TYPE_ACTION, TYPE_TRIAL = 1, 2, 3
+ACTION_MISS, ACTION_HIT, ACTION_DESTROY = 4, 5, 6
+
+sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+sock.bind(('127.0.0.1', port))
+sock.settimeout(window)
+print("Listening for telemetry on 127.0.0.1:{0}...".format(port))
+
+def reset():
+    return {'frames': [], 'queue': 0, 'hits': 0, 'misses': 0, 'trials': 0, 'lost': 0}
+
+stats = reset()
+nextSeq = None
+lastPrint = time.time()
+while True:
+    try:
+        data = sock.recv(256)
+        if len(data) < HEADER.size: continue
+        magic, version, msgType, seq, t = HEADER.unpack_from(data)
+        if magic != MAGIC: continue
+        if nextSeq is not None and seq > nextSeq: stats['lost'] += seq - nextSeq
+        nextSeq = seq + 1
+        if msgType == TYPE_FRAME:
+            rdt, sdt, idt, queue = FRAME.unpack_from(data, HEADER.size)
+            stats['frames'].append(rdt)
+            stats['queue'] = queue
+        elif msgType == TYPE_ACTION:
+            action, az, el = ACTION.unpack_from(data, HEADER.size)
+            if action in (ACTION_HIT, ACTION_DESTROY): stats['hits'] += 1
+            elif action == ACTION_MISS: stats['misses'] += 1
+        elif msgType == TYPE_TRIAL:
+            trialIdx, taskTime, destroyed, total = TRIAL.unpack_from(data, HEADER.size)
+            stats['trials'] += 1
+            print("Trial {0}: {1}/{2} targets destroyed in {3:0.3f}s".format(trialIdx, destroyed, total, taskTime))
+    except socket.timeout:
+        pass
+
+    now = time.time()
+    if now - lastPrint < window: continue
+    frames = stats['frames']
+    shots = stats['hits'] + stats['misses']
+    if len(frames) > 0:
+        mean = 1000.0 * sum(frames) / len(frames)
+        worst = 1000.0 * max(frames)
+        line = "{0:6.1f} fps | frame {1:6.2f} ms avg {2:6.2f} ms max".format(len(frames) / (now - lastPrint), mean, worst)
+    else:
+        line = "  (no frames)"
+    line += " | hit rate {0}".format("{0:5.1f}%".format(100.0 * stats['hits'] / shots) if shots > 0 else "  n/a")
+    line += " | logger queue {0:8.1f} kB | lost {1}".format(stats['queue'] / 1024.0, stats['lost'])
+    print(line)
+    stats = reset()
+    lastPrint = now
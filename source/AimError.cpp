@@ -0,0 +1,52 @@
+#include "AimError.h"
+#include <emmintrin.h>
+
+AimError computeAimError(const Point3& eye, const Vector3& look, const Array<float>& x, const Array<float>& y, const Array<float>& z, Array<float>& errors) {
+	const int count = x.size();
+	errors.resize(count, false);
+	AimError result;
+	result.targetCount = count;
+	if (count == 0) return result;
+
+	// The angle is computed as atan2(|look x d|, look . d), which (unlike acos) stays accurate for small errors.
+	// The dot/cross products are done 4 targets at a time, only the atan2 is per target.
+	const __m128 ex = _mm_set1_ps(eye.x), ey = _mm_set1_ps(eye.y), ez = _mm_set1_ps(eye.z);
+	const __m128 lx = _mm_set1_ps(look.x), ly = _mm_set1_ps(look.y), lz = _mm_set1_ps(look.z);
+	alignas(16) float dots[4];
+	alignas(16) float crosses[4];
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&x[i]), ex);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&y[i]), ey);
+		const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&z[i]), ez);
+		const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, dx), _mm_mul_ps(ly, dy)), _mm_mul_ps(lz, dz));
+		const __m128 cx = _mm_sub_ps(_mm_mul_ps(ly, dz), _mm_mul_ps(lz, dy));
+		const __m128 cy = _mm_sub_ps(_mm_mul_ps(lz, dx), _mm_mul_ps(lx, dz));
+		const __m128 cz = _mm_sub_ps(_mm_mul_ps(lx, dy), _mm_mul_ps(ly, dx));
+		const __m128 cross = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz)));
+		_mm_store_ps(dots, dot);
+		_mm_store_ps(crosses, cross);
+		for (int j = 0; j < 4; j++) {
+			errors[i + j] = atan2f(crosses[j], dots[j]);
+		}
+	}
+	// Remaining (< 4) targets
+	for (; i < count; i++) {
+		const Vector3 d(x[i] - eye.x, y[i] - eye.y, z[i] - eye.z);
+		errors[i] = atan2f(look.cross(d).length(), look.dot(d));
+	}
+
+	// Convert to degrees and summarize
+	float sum = 0.0f;
+	result.nearestError = finf();
+	for (i = 0; i < count; i++) {
+		errors[i] = toDegrees(errors[i]);
+		sum += errors[i];
+		if (errors[i] < result.nearestError) {
+			result.nearestError = errors[i];
+			result.nearestIdx = i;
+		}
+	}
+	result.meanError = sum / float(count);
+	return result;
+}
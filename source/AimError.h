@@ -0,0 +1,18 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Per-frame aim error summary (angle between the view direction and the direction to each target) */
+struct AimError {
+	FILETIME time;
+	int		targetCount = 0;			///< Number of live targets
+	int		nearestIdx = -1;			///< Index (into the position arrays) of the target nearest the view direction
+	String	nearestTarget = "";			///< Name of the nearest target (filled by the caller)
+	float	nearestError = 0.0f;		///< Angular error to the nearest target (deg)
+	float	meanError = 0.0f;			///< Mean angular error over all targets (deg)
+
+	AimError() {};
+};
+
+/** Compute the angular error (deg) from a view ray to each of x.size() points given as separate (SoA) coordinate arrays.
+	Per-target errors are written to errors (resized to match), the summary fields of the result are filled (except time). */
+AimError computeAimError(const Point3& eye, const Vector3& look, const Array<float>& x, const Array<float>& y, const Array<float>& z, Array<float>& errors);
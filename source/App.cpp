@@ -5,6 +5,9 @@
 #include "Session.h"
 #include "PhysicsScene.h"
 #include "WaypointManager.h"
+#include "HeadlessDriver.h"
+#include "MotionBenchmark.h"
+#include "ModelCache.h"
 #include <chrono>
 
 // Storage for configuration static vars
@@ -135,7 +138,7 @@ void App::loadDecals() {
 				};\
 				scale = %f;\
 			};", sessConfig->weapon.missDecal.c_str(), sessConfig->weapon.missDecalScale);
-		m_missDecalModel = ArticulatedModel::create(Any::parse(missDecalSpec), "missDecalModel");
+		m_missDecalModel = ModelCache::common().get(Any::parse(missDecalSpec), "missDecalModel");
 	}
 
 	if (sessConfig->weapon.hitDecal.empty()) {
@@ -157,7 +160,7 @@ void App::loadDecals() {
 				};\
 				scale = %f;\
 			};", sessConfig->weapon.hitDecal.c_str(), cmul, cmul, cmul, sessConfig->weapon.hitDecalScale);
-		m_hitDecalModel = ArticulatedModel::create(Any::parse(hitDecalSpec), "hitDecalModel");
+		m_hitDecalModel = ModelCache::common().get(Any::parse(hitDecalSpec), "hitDecalModel");
 	}
 }
 
@@ -171,7 +174,7 @@ void App::loadModels() {
 	Table<String, Any> targetsToBuild;
 	Table<String, String> explosionsToBuild;
 	Table<String, float> explosionScales;
-	for (TargetConfig target : experimentConfig.targets) {
+	for (const TargetConfig& target : experimentConfig.targets) {
 		targetsToBuild.set(target.id, target.modelSpec);
 		explosionsToBuild.set(target.id, target.destroyDecal);
 		explosionScales.set(target.id, target.destroyDecalScale);
@@ -192,55 +195,16 @@ void App::loadModels() {
 	explosionsToBuild.set("reference", "explosion_01.png");
 	explosionScales.set("reference", 1.0);
 
-	// Scale the models into the m_targetModel table
+	// Size the base model for each target (from the model cache's persisted bounds if possible), scaled (target/explosion) models are created on first use
+	targetModels.init(modelScaleCount);
 	for (String id : targetsToBuild.getKeys()) {
-		// Get the any specs
-		Any tSpec = targetsToBuild.get(id);
-		Any explosionSpec = Any::parse(format(
-			"ArticulatedModel::Specification {\
-				filename = \"ifs/square.ifs\";\
-				preprocess = {\
-					transformGeometry(all(), Matrix4::scale(0.1, 0.1, 0.1));\
-					setMaterial(all(), UniversalMaterial::Specification{\
-						lambertian = Texture::Specification {\
-							filename = \"%s\";\
-							encoding = Color3(1, 1, 1);\
-						};\
-					});\
-				};\
-			}", explosionsToBuild.get(id).c_str()));
-
-		// Get the bounding box to scale to size rather than arbitrary factor
-		shared_ptr<ArticulatedModel> size_model = ArticulatedModel::create(ArticulatedModel::Specification(tSpec));
-		AABox bbox;
-		size_model->getBoundingBox(bbox);
-		Vector3 extent = bbox.extent();
-		logPrintf("%20s bounding box: [%2.2f, %2.2f, %2.2f]\n", id.c_str(), extent[0], extent[1], extent[2]);
-		const float default_scale = 1.0f / extent[0];					// Setup scale so that default model is 1m across
-
-		// Create the target/explosion models for this target
-		Array<shared_ptr<ArticulatedModel>> tModels, expModels;
-		for (int i = 0; i <= modelScaleCount; ++i) {
-			const float scale = pow(1.0f + TARGET_MODEL_ARRAY_SCALING, float(i) - TARGET_MODEL_ARRAY_OFFSET);
-			tSpec.set("scale", scale*default_scale);
-			explosionSpec.set("scale", (20.0 * scale * explosionScales.get(id)));
-			tModels.push(ArticulatedModel::create(tSpec));
-			expModels.push(ArticulatedModel::create(explosionSpec));
-		}
-		targetModels.set(id, tModels);
-		m_explosionModels.set(id, expModels);
+		targetModels.add(id, targetsToBuild.get(id), explosionsToBuild.get(id), explosionScales.get(id));
 	}
 
-	// Create a series of colored materials to choose from for target health
-	for (int i = 0; i < m_MatTableSize; i++) {
-		float complete = (float)i / m_MatTableSize;
-		Color3 color = experimentConfig.targetView.healthColors[0] * complete + experimentConfig.targetView.healthColors[1] * (1.0f - complete);
-		UniversalMaterial::Specification materialSpecification;
-		materialSpecification.setLambertian(Texture::Specification(color));
-		materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
-		materialSpecification.setGlossy(Texture::Specification(Color4(0.4f, 0.2f, 0.1f, 0.8f)));
-		m_materials.append(UniversalMaterial::create(materialSpecification));
-	}
+	ModelCache::common().save();
+
+	// Create a series of colored materials/poses to choose from for target health
+	targetPalette.build(experimentConfig.targetView.healthColors, m_MatTableSize);
 }
 
 void App::updateControls() {
@@ -522,16 +486,8 @@ void App::updateSession(const String& id) {
 	m_weapon->loadSounds();
 	m_sceneHitSound = Sound::create(System::findDataFile(sessConfig->audio.sceneHitSound));
 
-	// Create a series of colored materials to choose from for target health
-	for (int i = 0; i < m_MatTableSize; i++) {
-		float complete = (float)i / m_MatTableSize;
-		Color3 color = sessConfig->targetView.healthColors[0] * complete + sessConfig->targetView.healthColors[1] * (1.0f - complete);
-		UniversalMaterial::Specification materialSpecification;
-		materialSpecification.setLambertian(Texture::Specification(color));
-		materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
-		materialSpecification.setGlossy(Texture::Specification(Color4(0.4f, 0.2f, 0.1f, 0.8f)));
-		m_materials.append(UniversalMaterial::create(materialSpecification));
-	}
+	// Rebuild the target health colors only if this session overrides them
+	targetPalette.build(sessConfig->targetView.healthColors, m_MatTableSize);
 
 	// Player parameters
 	shared_ptr<PlayerEntity> player = scene()->typedEntity<PlayerEntity>("player");
@@ -723,7 +679,7 @@ void App::simulateProjectiles(RealTime dt) {
 			float closest = finf();
 			Model::HitInfo info;
 			shared_ptr<TargetEntity> closestTarget;
-			for (shared_ptr<TargetEntity> t : sess->targetArray()) {
+			for (const shared_ptr<TargetEntity>& t : sess->targetArray()) {
 				if (t->intersect(ray, closest, info)) {
 					closestTarget = t;
 				}
@@ -742,7 +698,7 @@ void App::simulateProjectiles(RealTime dt) {
 				dontHit.append(m_currentMissDecals);
 				dontHit.append(m_explosions);
 				dontHit.append(sess->targetArray());
-				for (auto proj : m_projectileArray) { dontHit.append(proj.entity); }
+				for (const auto& proj : m_projectileArray) { dontHit.append(proj.entity); }
 				// Check for closest hit (in scene, otherwise this ray hits the skybox)
 				//closest = finf();
 				const Ray ray = projectile.getDecalRay();
@@ -776,8 +732,7 @@ void App::onSimulation(RealTime rdt, SimTime sdt, SimTime idt) {
 
 	// These are all we need from GApp::onSimulation() for walk mode
 	m_widgetManager->onSimulation(rdt, sdt, idt);
-	if (scene()) { scene()->onSimulation(sdt); }
-	if (scene()) { scene()->onSimulation(sdt); }
+	if (scene()) { scene()->onSimulation(sdt); sess->simulateTargetMotion(scene()->time(), sdt); }
 
 	// make sure mouse sensitivity is set right
 	if (m_userSettingsMode) {
@@ -1210,7 +1165,7 @@ void App::hitTarget(shared_ptr<TargetEntity> target) {
 	bool destroyedTarget = false;
 	if (target->name() == "reference") {
 		// Handle reference target here
-		sess->destroyTarget(target);
+		sess->destroyTarget(target->handle());
 		destroyedTarget = true;
 		sess->accumulatePlayerAction(PlayerActionType::Nontask, target->name());
 
@@ -1223,7 +1178,7 @@ void App::hitTarget(shared_ptr<TargetEntity> target) {
 		const shared_ptr<VisibleEntity> newExplosion = VisibleEntity::create(
 			format("explosion%d", m_explosionIdx), 
 			scene().get(), 
-			m_explosionModels.get(target->id())[target->scaleIndex()], 
+			targetModels.explosion(target->id(), target->scaleIndex()), 
 			explosionFrame
 		);
 		m_explosionIdx++;
@@ -1238,8 +1193,7 @@ void App::hitTarget(shared_ptr<TargetEntity> target) {
 		// check for respawn
 		if (!respawned) {
 			// This is the final respawn
-			//destroyTarget(hitIdx);
-			sess->destroyTarget(target);
+			sess->destroyTarget(target->handle());
 			destroyedTarget = true;
 		}
 		// Target eliminated, must be 'destroy'.
@@ -1257,16 +1211,7 @@ void App::hitTarget(shared_ptr<TargetEntity> target) {
 			sess->randomizePosition(target);
 		}
 		BEGIN_PROFILER_EVENT("fire/changeColor");
-		BEGIN_PROFILER_EVENT("fire/clone");
-		shared_ptr<ArticulatedModel::Pose> pose = dynamic_pointer_cast<ArticulatedModel::Pose>(target->pose()->clone());
-		END_PROFILER_EVENT();
-		BEGIN_PROFILER_EVENT("fire/materialSet");
-		shared_ptr<UniversalMaterial> mat = m_materials[min((int)(target->health()*m_MatTableSize), m_MatTableSize - 1)];
-		pose->materialTable.set("core/icosahedron_default", mat);
-		END_PROFILER_EVENT();
-		BEGIN_PROFILER_EVENT("fire/setPose");
-		target->setPose(pose);
-		END_PROFILER_EVENT();
+		target->setPalettePose(targetPalette.pose(targetPalette.healthIndex(target->health())));
 		END_PROFILER_EVENT();
 	}
 }
@@ -1330,7 +1275,7 @@ void App::onUserInput(UserInput* ui) {
 						Array<shared_ptr<Entity>> dontHit = { m_hitDecal };
 						dontHit.append(m_currentMissDecals);
 						dontHit.append(m_explosions);
-						for (auto projectile : m_projectileArray) { dontHit.append(projectile.entity); }
+						for (const auto& projectile : m_projectileArray) { dontHit.append(projectile.entity); }
 						Model::HitInfo info;
 						float hitDist = finf();
 						int hitIdx = -1;
@@ -1383,7 +1328,7 @@ void App::onUserInput(UserInput* ui) {
 			Array<shared_ptr<Entity>> dontHit;
 			dontHit.append(m_currentMissDecals);
 			dontHit.append(m_explosions);
-			for (auto projectile : m_projectileArray) { dontHit.append(projectile.entity); }
+			for (const auto& projectile : m_projectileArray) { dontHit.append(projectile.entity); }
 			Model::HitInfo info;
 			float hitDist = finf();
 			int hitIdx = -1;
@@ -1510,6 +1455,9 @@ void App::setReticle(const int r) {
 void App::onCleanup() {
 	// Called after the application loop ends.  Place a majority of cleanup code
 	// here instead of in the constructor so that exceptions can be caught.
+
+	// Release cached models (and their GL resources) while the GL context still exists
+	ModelCache::common().clearModels();
 }
 
 /** Overridden (optimized) oneFrame() function to improve latency */
@@ -1699,6 +1647,18 @@ void App::oneFrame() {
     }
     END_PROFILER_EVENT();
 
+    // Frame timing (stage durations are from the most recent tick/tock of each watch)
+    if (notNull(sess)) {
+        FrameInfo info(Logger::getFileTime(), m_previousRealTimeStep, m_previousSimTimeStep, float(m_wallClockTargetDuration));
+        info.userInputDuration = float(m_userInputWatch.elapsedTime());
+        info.simulationDuration = float(m_simulationWatch.elapsedTime());
+        info.poseDuration = float(m_poseWatch.elapsedTime());
+        info.waitDuration = float(m_waitWatch.elapsedTime());
+        info.graphicsDuration = float(m_graphicsWatch.elapsedTime());
+        info.overWait = float(m_lastFrameOverWait);
+        sess->accumulateFrameInfo(info);
+    }
+
     // Remove all expired debug shapes
     for (int i = 0; i < debugShapeArray.size(); ++i) {
         if (debugShapeArray[i].endTime <= m_now) {
@@ -1738,6 +1698,16 @@ int main(int argc, const char* argv[]) {
         startupConfig.toAny(true).save("startupconfig.Any");
     }
 
+	// Headless mode runs the CPU-side simulation only (no window/GL context)
+	if (HeadlessDriver::requested(argc, argv)) {
+		initG3D();
+		return HeadlessDriver::run(HeadlessDriver::parseArgs(argc, argv), startupConfig.experimentConfig());
+	}
+	if (MotionBenchmark::requested(argc, argv)) {
+		initG3D();
+		return MotionBenchmark::run(MotionBenchmark::parseArgs(argc, argv));
+	}
+
 	{
 		G3DSpecification spec;
         spec.audio = startupConfig.audioEnable;
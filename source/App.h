@@ -12,6 +12,8 @@
 #include <G3D/G3D.h>
 #include "ConfigFiles.h"
 #include "TargetEntity.h"
+#include "TargetPalette.h"
+#include "TargetModelTable.h"
 #include "PlayerEntity.h"
 #include "GuiElements.h"
 #include "PyLogger.h"
@@ -111,7 +113,6 @@ protected:
 	const int								m_maxExplosions = 20;				///< Maximum number of simultaneous explosions
 		
 	const int								m_MatTableSize = 10;				///< Set this to set # of color "levels"
-	Array<shared_ptr<UniversalMaterial>>	m_materials;						///< This stores the color materials
 
 	GuiDropDownList*						m_sessDropDown;						///< Dropdown menu for session selection
 	GuiDropDownList*						m_userDropDown;						///< Dropdown menu for user selection
@@ -122,7 +123,6 @@ protected:
 	shared_ptr<RenderControls>				m_renderControls;
 	shared_ptr<WeaponControls>				m_weaponControls;
 
-	Table<String, Array<shared_ptr<ArticulatedModel>>> m_explosionModels;
 
 	/** Used for visualizing history of frame times. Temporary, awaiting a G3D built-in that does this directly with a texture. */
 	Queue<float>							m_frameDurationQueue;				///< Queue for history of frrame times
@@ -196,8 +196,9 @@ public:
 	shared_ptr<SessionConfig>		sessConfig = SessionConfig::create();			///< Current session config
 	shared_ptr<G3Dialog>			dialog;							///< Dialog box
 
-	Table<String, Array<shared_ptr<ArticulatedModel>>>	targetModels;
-	const int											modelScaleCount = 30;
+	TargetModelTable									targetModels;				///< Target/explosion models by ID and scale index (created on first use)
+	const int											modelScaleCount = TARGET_MODEL_SCALE_COUNT;
+	TargetPalette										targetPalette;				///< Shared target health color materials/poses
 
 	shared_ptr<Session> sess;										///< Pointer to the experiment
 
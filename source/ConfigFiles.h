@@ -806,10 +806,13 @@ public:
 	Array<float>	accelGravity = { 9.8f, 9.8f };			///< Range of acceleration due to gravity in meters/s^2
 	Array<Destination> destinations;						///< Array of destinations to traverse
 	String			destSpace = "world";					///< Space to use for destinations (implies offset) can be "world" or "player"
+	String			pathInterpolation = "linear";			///< Interpolation between destinations, can be "linear" or "catmullrom"
 	int				respawnCount = 0;						///< Number of times to respawn
 	AABox			spawnBounds;							///< Spawn position bounding box
 	AABox			moveBounds;								///< Movemvent bounding box
 	Array<bool>		axisLock = { false, false, false };		///< Array of axis lock values
+	float			bakeRate = 0.0f;						///< Rate (Hz) to pre-simulate (bake) parametric motion at before the trial (0 simulates live)
+	float			bakeDuration = 30.0f;					///< Length (s) of a baked path (it loops for targets that live longer)
 
 	String			destroyDecal = "explosion_01.png";		///< Decal to use for destroy event
 	float			destroyDecalScale = 1.0;				///< Scale to apply to destroy (relative to target size)
@@ -835,6 +838,12 @@ public:
 
 	TargetConfig() {}
 
+	/** Is this a parametric target whose motion is baked into a path before each trial? */
+	bool isBaked() const { return bakeRate > 0.0f && destinations.size() == 0; }
+
+	/** Is this a world space flying target (whose motion runs in a WorldMotionBatch)? */
+	bool isBatchedWorldMotion() const { return destSpace == "world" && destinations.size() == 0 && !jumpEnabled && !isBaked(); }
+
 	/** Load from Any */
 	TargetConfig(const Any& any) {
 		int settingsVersion = 1;
@@ -865,6 +874,10 @@ public:
 			
 			reader.getIfPresent("destSpace", destSpace);
 			reader.getIfPresent("destinations", destinations);
+			reader.getIfPresent("pathInterpolation", pathInterpolation);
+			if (pathInterpolation != "linear" && pathInterpolation != "catmullrom") {
+				throw format("Unknown \"pathInterpolation\" (\"%s\") for target \"%s\", must be \"linear\" or \"catmullrom\"!", pathInterpolation, id);
+			}
 			reader.getIfPresent("respawnCount", respawnCount);
 			if (destSpace == "world" && destinations.size() == 0) {
 				reader.get("moveBounds", moveBounds, format("A world-space target must either specify destinations or a movement bounding box. See target: \"%s\"", id));
@@ -892,6 +905,11 @@ public:
 					throw format("Target \"%s\" locks all axes but has non-zero speed!", id);
 				}
 			}
+			reader.getIfPresent("bakeRate", bakeRate);
+			reader.getIfPresent("bakeDuration", bakeDuration);
+			if (bakeRate > 0.0f && bakeDuration <= 0.0f) {
+				throw format("Target \"%s\" bakes its motion but has a non-positive \"bakeDuration\"!", id);
+			}
 			reader.getIfPresent("hitSound", hitSound);
 			reader.getIfPresent("hitSoundVol", hitSoundVol);
 			reader.getIfPresent("destroyedSound", destroyedSound);
@@ -913,7 +931,10 @@ public:
 		if(forceAll || def.size != size)										a["visualSize"] = size;
 		if(forceAll || def.logTargetTrajectory != logTargetTrajectory)			a["logTargetTrajectory"] = logTargetTrajectory;
 		// Destination-based target
-		if (destinations.size() > 0) 											a["destinations"] = destinations;
+		if (destinations.size() > 0) {
+			a["destinations"] = destinations;
+			if(forceAll || def.pathInterpolation != pathInterpolation)			a["pathInterpolation"] = pathInterpolation;
+		}
 		// Parametric target
 		else {												
 			if(forceAll || def.upperHemisphereOnly != upperHemisphereOnly)		a["upperHemisphereOnly"] = upperHemisphereOnly;
@@ -925,6 +946,8 @@ public:
 			if(forceAll || def.jumpEnabled != jumpEnabled)						a["jumpEnabled"] = jumpEnabled;
 			if(forceAll || def.jumpPeriod != jumpPeriod)						a["jumpPeriod"] = jumpPeriod;
 			if(forceAll || def.accelGravity != accelGravity)					a["accelGravity"] = accelGravity;
+			if(forceAll || def.bakeRate != bakeRate)							a["bakeRate"] = bakeRate;
+			if(forceAll || def.bakeDuration != bakeDuration)					a["bakeDuration"] = bakeDuration;
 			if(forceAll || def.axisLock != axisLock)							a["axisLocked"] = axisLock;
 		}
 
@@ -1380,6 +1403,8 @@ public:
 	float           readyDuration = 0.5f;						///< Time in ready state in seconds
 	float           taskDuration = 100000.0f;					///< Maximum time spent in any one task
 	float           feedbackDuration = 1.0f;					///< Time in feedback state in seconds
+	float			targetSimRate = 0.0f;						///< Fixed rate (Hz) to simulate target motion at (0 simulates once per frame)
+	int				targetSimThreads = 0;						///< Threads to simulate target motion on (0 for the main thread only, -1 for all hardware threads)
 	// Trial count
 	int             defaultTrialCount = 5;						///< Default trial count
 
@@ -1389,6 +1414,8 @@ public:
 			reader.getIfPresent("feedbackDuration", feedbackDuration);
 			reader.getIfPresent("readyDuration", readyDuration);
 			reader.getIfPresent("taskDuration", taskDuration);
+			reader.getIfPresent("targetSimRate", targetSimRate);
+			reader.getIfPresent("targetSimThreads", targetSimThreads);
 			reader.getIfPresent("defaultTrialCount", defaultTrialCount);
 			break;
 		default:
@@ -1402,6 +1429,8 @@ public:
 		if(forceAll || def.feedbackDuration != feedbackDuration)	a["feedbackDuration"] = feedbackDuration;
 		if(forceAll || def.readyDuration != readyDuration)			a["readyDuration"] = readyDuration;
 		if(forceAll || def.taskDuration != taskDuration)			a["taskDuration"] = taskDuration;
+		if(forceAll || def.targetSimRate != targetSimRate)			a["targetSimRate"] = targetSimRate;
+		if(forceAll || def.targetSimThreads != targetSimThreads)	a["targetSimThreads"] = targetSimThreads;
 		if(forceAll || def.defaultTrialCount != defaultTrialCount)	a["defaultTrialCount"] = defaultTrialCount;
 		return a;
 	}
@@ -1416,6 +1445,14 @@ public:
 	bool logPlayerActions		= true;		///< Log player actions in table?
 	bool logTrialResponse		= true;		///< Log trial response in table?
 	bool logUsers				= true;		///< Log user infomration in table?
+	bool logRawInput			= false;	///< Capture and log raw (per-event) mouse input in table?
+	bool logStateTimeline		= true;		///< Log presentation state transitions in table?
+	bool logTrialPlan			= true;		///< Log the compiled trial plan in table (and a CSV file)?
+	bool logAimError			= true;		///< Log per-frame (nearest/mean) aim error in table?
+
+	// Live telemetry
+	bool telemetryEnable		= false;	///< Publish live telemetry to a loopback port?
+	int telemetryPort			= 19550;	///< Loopback (UDP) port to publish telemetry to
 
 	// Session parameter logging
 	Array<String> sessParamsToLog;			///< Parameter names to log to the Sessions table of the DB
@@ -1429,6 +1466,12 @@ public:
 			reader.getIfPresent("logPlayerActions", logPlayerActions);
 			reader.getIfPresent("logTrialResponse", logTrialResponse);
 			reader.getIfPresent("logUsers", logUsers);
+			reader.getIfPresent("logRawInput", logRawInput);
+			reader.getIfPresent("logStateTimeline", logStateTimeline);
+			reader.getIfPresent("logTrialPlan", logTrialPlan);
+			reader.getIfPresent("logAimError", logAimError);
+			reader.getIfPresent("telemetryEnable", telemetryEnable);
+			reader.getIfPresent("telemetryPort", telemetryPort);
 			reader.getIfPresent("sessParamsToLog", sessParamsToLog);
 			break;
 		default:
@@ -1445,6 +1488,12 @@ public:
 		if(forceAll || def.logPlayerActions != logPlayerActions)			a["logPlayerActions"] = logPlayerActions;
 		if(forceAll || def.logTrialResponse != logTrialResponse)			a["logTrialResponse"] = logTrialResponse;
 		if(forceAll || def.logUsers != logUsers)							a["logUsers"] = logUsers;
+		if(forceAll || def.logRawInput != logRawInput)						a["logRawInput"] = logRawInput;
+		if(forceAll || def.logStateTimeline != logStateTimeline)			a["logStateTimeline"] = logStateTimeline;
+		if(forceAll || def.logTrialPlan != logTrialPlan)					a["logTrialPlan"] = logTrialPlan;
+		if(forceAll || def.logAimError != logAimError)						a["logAimError"] = logAimError;
+		if(forceAll || def.telemetryEnable != telemetryEnable)				a["telemetryEnable"] = telemetryEnable;
+		if(forceAll || def.telemetryPort != telemetryPort)					a["telemetryPort"] = telemetryPort;
 		if(forceAll || def.sessParamsToLog != sessParamsToLog)				a["sessParamsToLog"] = sessParamsToLog;
 		return a;
 	}
@@ -1454,6 +1503,7 @@ class FpsConfig : public ReferenceCountedObject {
 public:
 	int	            settingsVersion = 1;						///< Settings version
 	String          sceneName = "";							    ///< Scene name
+	int				randomSeed = -1;							///< Seed for session/target random streams (-1 to pick one per session)
 
 	// Sub structures
 	RenderConfig		render;									///< Render related config parameters
@@ -1493,6 +1543,7 @@ public:
 		switch (settingsVersion) {
 		case 1:
 			reader.getIfPresent("sceneName", sceneName);
+			reader.getIfPresent("randomSeed", randomSeed);
 			reader.getIfPresent("weapon", weapon);
 			reader.getIfPresent("questions", questionArray);
 			break;
@@ -1507,6 +1558,7 @@ public:
 		FpsConfig def;
 		a["settingsVersion"] = settingsVersion;
 		if(forceAll || def.sceneName != sceneName) a["sceneName"] = sceneName;
+		if(forceAll || def.randomSeed != randomSeed) a["randomSeed"] = randomSeed;
 		a = render.addToAny(a, forceAll);
 		a = player.addToAny(a, forceAll);
 		a = hud.addToAny(a, forceAll);
@@ -1579,6 +1631,22 @@ public:
 
 /** Experiment configuration */
 class ExperimentConfig : public FpsConfig {
+protected:
+	Table<String, int> m_sessionIdx;									///< Session index (into sessions) by ID
+	Table<String, shared_ptr<const TargetConfig>> m_targetsById;		///< Shared (immutable) target configs by ID
+
+	/** Build the ID lookup tables (call after sessions/targets change) */
+	void buildIndex() {
+		m_sessionIdx.clear();
+		for (int i = 0; i < sessions.size(); i++) {
+			m_sessionIdx.set(sessions[i].id, i);
+		}
+		m_targetsById.clear();
+		for (const TargetConfig& target : targets) {
+			m_targetsById.set(target.id, TargetConfig::createShared<TargetConfig>(target));
+		}
+	}
+
 public:
 	String description = "Experiment";					///< Experiment description
 	Array<SessionConfig> sessions;						///< Array of sessions
@@ -1660,6 +1728,8 @@ public:
 			
 			sessions.append(sess30);
 		}
+
+		buildIndex();
 	}
 
 	/** Get an array of session IDs */
@@ -1668,49 +1738,39 @@ public:
 		for (const SessionConfig& session : sessions) { ids.append(session.id); }
 	}
 
-	/** Get a session config based on its ID */
+	/** Get a (mutable) copy of a session config based on its ID */
 	shared_ptr<SessionConfig> getSessionConfigById(const String& id) const {
-		for (const SessionConfig& session : sessions) {
-			if (! session.id.compare(id)) {
-                return SessionConfig::createShared<SessionConfig>(session);
-            }
-		}
-		return nullptr;
+		const int* idx = m_sessionIdx.getPointer(id);
+		if (isNull(idx)) return nullptr;
+		return SessionConfig::createShared<SessionConfig>(sessions[*idx]);
 	}
 
 	/** Get the index of a session in the session array (by ID) */
 	int getSessionIndex(const String& id) const {
-        debugAssert(sessions.size() >= 0 && sessions.size() < 100000);
-        for (int i = 0; i < sessions.size(); ++i) {
-			if (! sessions[i].id.compare(id)) {
-                return i;
-            }
+		const int* idx = m_sessionIdx.getPointer(id);
+		if (isNull(idx)) {
+			throw format("Could not find session:\"%s\"", id);
 		}
-		throw format("Could not find session:\"%s\"", id);
+		return *idx;
 	}
 	
-	/** Get a pointer to a target config by ID */
-	shared_ptr<TargetConfig> getTargetConfigById(const String& id) const {
-        for (const TargetConfig& target : targets) { 
-			if (!target.id.compare(id)) {
-				return TargetConfig::createShared<TargetConfig>(target);
-			}
-		}
-		return nullptr;
+	/** Get a pointer to the (shared, immutable) target config by ID */
+	shared_ptr<const TargetConfig> getTargetConfigById(const String& id) const {
+		const shared_ptr<const TargetConfig>* target = m_targetsById.getPointer(id);
+		return isNull(target) ? nullptr : *target;
 	}
 
-	Array<Array<shared_ptr<TargetConfig>>> getTargetsForSession(const String& id) const {
+	Array<Array<shared_ptr<const TargetConfig>>> getTargetsForSession(const String& id) const {
 		return getTargetsForSession(getSessionIndex(id));
 	}
 
-	Array<Array<shared_ptr<TargetConfig>>> getTargetsForSession(int sessionIndex) const {
-		Array<Array<shared_ptr<TargetConfig>>> trials;
+	Array<Array<shared_ptr<const TargetConfig>>> getTargetsForSession(int sessionIndex) const {
+		Array<Array<shared_ptr<const TargetConfig>>> trials;
 		// Iterate through the trials
 		for (int i = 0; i < sessions[sessionIndex].trials.size(); i++) {
-			Array<shared_ptr<TargetConfig>> targets;
-			for (String id : sessions[sessionIndex].trials[i].ids) {
-				const shared_ptr<TargetConfig> t = getTargetConfigById(id);
-				targets.append(t);
+			Array<shared_ptr<const TargetConfig>> targets;
+			for (const String& id : sessions[sessionIndex].trials[i].ids) {
+				targets.append(getTargetConfigById(id));
 			}
 			trials.append(targets);
 		}
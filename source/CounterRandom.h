@@ -0,0 +1,82 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Counter-based (Philox2x32-10) random number stream.
+	Every value is a pure function of (key, stream, counter), so a stream produces the same
+	sequence regardless of how draws from other streams (or the global Random::common()) are
+	interleaved with it. Copying a stream copies its position. */
+class CounterRandom {
+protected:
+	uint32 m_key = 0;			///< Key (session seed)
+	uint32 m_stream = 0;		///< Stream index (high word of the counter)
+	uint32 m_counter = 0;		///< Draw index (low word of the counter)
+
+	static uint64 philox(uint32 key, uint32 c0, uint32 c1) {
+		for (int round = 0; round < 10; round++) {
+			const uint64 product = uint64(0xD256D193u) * c0;
+			c0 = uint32(product >> 32) ^ key ^ c1;
+			c1 = uint32(product);
+			key += 0x9E3779B9u;
+		}
+		return (uint64(c0) << 32) | c1;
+	}
+
+public:
+	CounterRandom() {}
+	CounterRandom(uint32 key, uint32 stream) : m_key(key), m_stream(stream) {}
+
+	/** Stream index for a target, by (session-wide) trial number and parameter index (stream 0 is reserved for the session) */
+	static uint32 targetStream(int trialNumber, int paramIdx) {
+		return (uint32(trialNumber) << 12) + uint32(paramIdx) + 1;
+	}
+
+	/** Stream index for simulated aim jitter (headless runs), kept clear of the session (0) and target streams */
+	static uint32 aimStream() {
+		return 0xFFFFFFFFu;
+	}
+
+	uint32 bits() {
+		return uint32(philox(m_key, m_counter++, m_stream) >> 32);
+	}
+
+	/** Uniform in [0, 1) */
+	float uniform() {
+		return float(bits() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	/** Uniform in [low, high) */
+	float uniform(float low, float high) {
+		return low + (high - low) * uniform();
+	}
+
+	/** Uniform integer in [low, high] */
+	int integer(int low, int high) {
+		return low + int(bits() % uint32(high - low + 1));
+	}
+
+	/** Randomly returns either +1 or -1 */
+	float sign() {
+		return (uniform() > 0.5f) ? 1.0f : -1.0f;
+	}
+
+	/** Uniformly distributed unit vector */
+	Vector3 sphere() {
+		const float z = uniform(-1.0f, 1.0f);
+		const float phi = uniform(0.0f, 2.0f * pif());
+		const float r = sqrt(max(0.0f, 1.0f - z * z));
+		return Vector3(r * cos(phi), r * sin(phi), z);
+	}
+
+	/** Uniformly distributed point inside the box */
+	Point3 randomInteriorPoint(const AABox& box) {
+		const Vector3 extent = box.high() - box.low();
+		const float x = uniform(), y = uniform(), z = uniform();
+		return box.low() + Vector3(x, y, z) * extent;
+	}
+
+	/** Move to an absolute position in the stream (e.g. to resume a stream from a logged counter) */
+	void setCounter(uint32 counter) { m_counter = counter; }
+
+	uint32 counter() const { return m_counter; }
+	uint32 stream() const { return m_stream; }
+};
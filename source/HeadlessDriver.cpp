@@ -0,0 +1,226 @@
+#include "HeadlessDriver.h"
+#include "TargetEntity.h"
+#include "Logger.h"
+#include "Session.h"
+#include "TargetMotion.h"
+#include "TrialPlan.h"
+#include "TrajectoryBaker.h"
+
+bool HeadlessDriver::requested(int argc, const char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (String(argv[i]) == "--headless") return true;
+	}
+	return false;
+}
+
+HeadlessDriver::Settings HeadlessDriver::parseArgs(int argc, const char* argv[]) {
+	Settings s;
+	for (int i = 1; i < argc; i++) {
+		const String arg = argv[i];
+		const bool hasValue = (i + 1) < argc;
+		if (arg == "--session" && hasValue)			{ s.sessionId = argv[++i]; }
+		else if (arg == "--dt" && hasValue)			{ s.timestep = (SimTime)atof(argv[++i]); }
+		else if (arg == "--duration" && hasValue)	{ s.maxTrialDuration = (SimTime)atof(argv[++i]); }
+		else if (arg == "--threads" && hasValue)	{ s.threads = atoi(argv[++i]); }
+		else if (arg == "--nolog")					{ s.log = false; }
+	}
+	alwaysAssertM(s.timestep > 0.0f, "Headless timestep must be positive!");
+	return s;
+}
+
+int HeadlessDriver::run(const Settings& settings, const String& experimentFilename) {
+	const ExperimentConfig experiment = ExperimentConfig::load(experimentFilename);
+
+	Array<String> sessionIds;
+	if (settings.sessionId.empty()) {
+		experiment.getSessionIds(sessionIds);
+	}
+	else if (notNull(experiment.getSessionConfigById(settings.sessionId))) {
+		sessionIds.append(settings.sessionId);
+	}
+	else {
+		printf("Session \"%s\" not found in %s\n", settings.sessionId.c_str(), experimentFilename.c_str());
+		return -1;
+	}
+
+	printf("Headless run of %s: %d session(s), dt = %0.3fms, trial duration <= %0.1fs, %d motion thread(s)\n",
+		experimentFilename.c_str(), sessionIds.size(), 1e3f * settings.timestep, settings.maxTrialDuration, max(1, settings.threads));
+
+	Timings all;
+	for (const String& id : sessionIds) {
+		Timings t;
+		runSession(settings, experiment, id, t);
+		report(id, t);
+		all.frames += t.frames;		all.shots += t.shots;			all.hits += t.hits;
+		all.spawn += t.spawn;		all.simulation += t.simulation;	all.hitTest += t.hitTest;
+		all.logging += t.logging;	all.total += t.total;
+	}
+	report("all sessions", all);
+	return 0;
+}
+
+void HeadlessDriver::runSession(const Settings& settings, const ExperimentConfig& experiment, const String& sessionId, Timings& timings) {
+	const RealTime sessionStart = System::time();
+	shared_ptr<SessionConfig> sessConfig = experiment.getSessionConfigById(sessionId);
+	const Array<Array<shared_ptr<const TargetConfig>>> trials = experiment.getTargetsForSession(sessionId);
+
+	// Use the configured seed (if any) so headless runs reproduce session motion
+	if (sessConfig->randomSeed < 0) {
+		sessConfig->randomSeed = int(Random::common().bits() & 0x7FFFFFFF);
+	}
+	const uint32 seed = uint32(sessConfig->randomSeed);
+	CounterRandom aimRng(seed, CounterRandom::aimStream());
+
+	shared_ptr<Logger> logger;
+	if (settings.log && sessConfig->logger.enable) {
+		if (!FileSystem::isDirectory("../results")) {
+			FileSystem::createDirectory("../results");
+		}
+		const String logName = "../results/" + sessionId + "_headless_" + String(Logger::genFileTimestamp()) + ".db";
+		logger = Logger::create(logName, "headless", sessConfig, "Headless benchmark");
+	}
+
+	// The (virtual) player sits at the origin, targets orbit around it
+	const Point3 playerPos = Point3::zero();
+	const float targetDistance = 1.0f;
+	const float damagePerShot = sessConfig->weapon.damagePerSecond * max(sessConfig->weapon.firePeriod, settings.timestep);
+	const SimTime firePeriod = max(sessConfig->weapon.firePeriod, settings.timestep);
+	const SimTime trialDuration = min((SimTime)sessConfig->timing.taskDuration, settings.maxTrialDuration);
+	TargetWorkerPool motionWorkers;
+	motionWorkers.start((settings.threads < 0) ? (int)std::thread::hardware_concurrency() : settings.threads);
+
+	// Plan the trial order and spawn parameters exactly as Session does (sessions w/ infinite trials run one trial per condition)
+	Array<int> trialCounts;
+	for (int i = 0; i < trials.size(); i++) {
+		trialCounts.append(sessConfig->trials[i].count);
+	}
+	TrialPlan plan;
+	plan.init(trials, trialCounts, seed, TARGET_MODEL_SCALE_COUNT);
+	if (plan.isFinite()) {
+		plan.compileAll();
+	}
+	else {
+		plan.compile(trials.size());
+	}
+
+	for (int trialNumber = 0; trialNumber < plan.size(); trialNumber++) {
+		const PlannedTrial& planned = plan[trialNumber];
+		const int trialIdx = planned.trialIdx;
+
+		// Spawn targets (no scene or model, motion only)
+		RealTime t0 = System::time();
+		Array<shared_ptr<TargetEntity>> targets;
+		WorldMotionBatch worldMotion;
+		for (int i = 0; i < planned.targets.size(); i++) {
+			const shared_ptr<const TargetConfig>& config = trials[trialIdx][i];
+			const PlannedTarget& p = planned.targets[i];
+			const bool isWorldSpace = config->destSpace == "world";
+			// The target's stream resumes where the plan's draws left off (as in Session::prefetchTrial())
+			CounterRandom rng(seed, CounterRandom::targetStream(trialNumber, i));
+			rng.setCounter(p.rngCounter);
+			const CFrame f = CFrame::fromXYZYPRDegrees(playerPos.x, playerPos.y, playerPos.z, p.yaw, p.pitch, 0.0f);
+			const String name = format("%s_%d_%s_%d", sessionId.c_str(), trialIdx, config->id.c_str(), i);
+			const Point3 playerSpacePos = f.pointToWorldSpace(Point3(0, 0, -targetDistance));
+
+			// Same construction/spawn as Session::prefetchTrial()/spawnPrefetchedTarget() (baked targets are baked synchronously here)
+			Array<Destination> path;
+			if (config->isBaked()) {
+				const SimTime duration = min(config->bakeDuration, sessConfig->timing.taskDuration);
+				path = TrajectoryBaker::bake(config, isWorldSpace ? p.spawnPos : playerSpacePos, playerPos, targetDistance, i, rng, duration, 0.001f);
+			}
+			const shared_ptr<TargetEntity> target = TargetEntity::createFromConfig(config, name, nullptr, nullptr, p.scaleIdx, i, targetDistance, rng);
+			TargetEntity::spawnFromConfig(target, config, name, i, rng, playerPos, targetDistance, playerSpacePos, p.spawnPos, path);
+			target->setExternalMotion(motionWorkers.enabled());
+			targets.append(target);
+			if (config->isBatchedWorldMotion()) {
+				worldMotion.add(std::static_pointer_cast<FlyingEntity>(target));
+			}
+		}
+		timings.spawn += System::time() - t0;
+
+		// Fixed timestep loop
+		SimTime time = 0.0f;
+		SimTime nextShot = firePeriod;
+		while (time < trialDuration && targets.size() > 0) {
+			time += settings.timestep;
+			timings.frames++;
+
+			// Target motion
+			t0 = System::time();
+			for (const shared_ptr<TargetEntity>& target : targets) {
+				target->onSimulation(time, settings.timestep);
+			}
+			if (motionWorkers.enabled()) {
+				motionWorkers.simulate(targets, time, settings.timestep);
+			}
+			worldMotion.simulate(time, settings.timestep);
+			const RealTime t1 = System::time();
+			timings.simulation += t1 - t0;
+
+			// Hit test (aim near the first target w/ some jitter, as a hitscan weapon would)
+			String hitName = "";
+			if (time >= nextShot) {
+				nextShot += firePeriod;
+				timings.shots++;
+				const Vector3 aimDir = (targets[0]->frame().translation - playerPos).direction() + aimRng.sphere() * 0.02f;
+				const Ray ray = Ray::fromOriginAndDirection(playerPos, aimDir.direction());
+				float closest = finf();
+				int closestIdx = -1;
+				for (int i = 0; i < targets.size(); i++) {
+					const float hitTime = ray.intersectionTime(Sphere(targets[i]->frame().translation, BOUNDING_SPHERE_RADIUS * targets[i]->size()));
+					if (hitTime < closest) {
+						closest = hitTime;
+						closestIdx = i;
+					}
+				}
+				if (closestIdx >= 0) {
+					timings.hits++;
+					const shared_ptr<TargetEntity> target = targets[closestIdx];
+					hitName = target->name();
+					if (target->doDamage(damagePerShot) && !target->respawn()) {
+						worldMotion.remove(target);
+						targets.fastRemove(closestIdx);
+					}
+				}
+			}
+			const RealTime t2 = System::time();
+			timings.hitTest += t2 - t1;
+
+			// Logging
+			if (notNull(logger)) {
+				const FILETIME ft = Logger::getFileTime();
+				FrameInfo info(ft, settings.timestep, settings.timestep, settings.timestep);
+				info.simulationDuration = float(t1 - t0);
+				logger->logFrameInfo(info);
+				for (const shared_ptr<TargetEntity>& target : targets) {
+					if (target->isLogged()) {
+						logger->logTargetLocation(TargetLocation(ft, target->name(), target->frame().translation - playerPos));
+					}
+				}
+				if (!hitName.empty()) {
+					logger->logPlayerAction(PlayerAction(ft, Point2::zero(), playerPos, PlayerActionType::Hit, hitName));
+				}
+			}
+			timings.logging += System::time() - t2;
+		}
+	}
+
+	// Destroying the logger waits for it to write out the remaining rows
+	{
+		const RealTime t0 = System::time();
+		logger.reset();
+		timings.logging += System::time() - t0;
+	}
+	timings.total = System::time() - sessionStart;
+}
+
+void HeadlessDriver::report(const String& name, const Timings& t) {
+	const double fps = (t.total > 0.0) ? t.frames / t.total : 0.0;
+	const double perFrame = (t.frames > 0) ? 1e6 / t.frames : 0.0;
+	const String msg = format("[%s] %d frames in %0.3fs (%0.0f simulated frames/s), %d/%d hits\n"
+		"\tspawn %0.3fs | simulation %0.3fs (%0.2fus/frame) | hit test %0.3fs (%0.2fus/frame) | logging %0.3fs (%0.2fus/frame)\n",
+		name.c_str(), t.frames, t.total, fps, t.hits, t.shots,
+		t.spawn, t.simulation, t.simulation * perFrame, t.hitTest, t.hitTest * perFrame, t.logging, t.logging * perFrame);
+	printf("%s", msg.c_str());
+	logPrintf("%s", msg.c_str());
+}
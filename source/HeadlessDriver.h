@@ -0,0 +1,44 @@
+#pragma once
+#include <G3D/G3D.h>
+#include "ConfigFiles.h"
+
+/** Drives the CPU side of an experiment (target motion, hit testing and logging) at a fixed
+	timestep with no window, GL context or rendering, and reports simulation throughput.
+
+	Run as: FirstPersonScience.exe --headless [--session id] [--dt seconds] [--duration seconds] [--threads n] [--nolog]
+*/
+class HeadlessDriver {
+public:
+	struct Settings {
+		String		sessionId = "";				///< Session to run (empty for all sessions)
+		SimTime		timestep = 0.001f;			///< Fixed simulation timestep (s)
+		SimTime		maxTrialDuration = 10.0f;	///< Cap on (simulated) trial duration (s)
+		int			threads = 0;				///< Threads to simulate target motion on (0 for the main thread only)
+		bool		log = true;					///< Write results databases (if enabled in the session config)
+	};
+
+	/** Per-subsystem time accumulators (wall clock seconds) */
+	struct Timings {
+		int			frames = 0;
+		int			shots = 0;
+		int			hits = 0;
+		RealTime	spawn = 0.0;
+		RealTime	simulation = 0.0;
+		RealTime	hitTest = 0.0;
+		RealTime	logging = 0.0;
+		RealTime	total = 0.0;
+	};
+
+	/** Returns true if the command line requests a headless run */
+	static bool requested(int argc, const char* argv[]);
+
+	/** Parse settings from the command line */
+	static Settings parseArgs(int argc, const char* argv[]);
+
+	/** Run the experiment in experimentFilename headlessly, returns a process exit code */
+	static int run(const Settings& settings, const String& experimentFilename);
+
+protected:
+	static void runSession(const Settings& settings, const ExperimentConfig& experiment, const String& sessionId, Timings& timings);
+	static void report(const String& name, const Timings& timings);
+};
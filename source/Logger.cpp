@@ -63,7 +63,8 @@ void Logger::createResultsFile(const String& filename,
 			{ "sessionID", "text", "NOT NULL"},
 			{ "time", "text", "NOT NULL" },
 			{ "subjectID", "text", "NOT NULL" },
-			{ "appendingDescription", "text"}
+			{ "appendingDescription", "text"},
+			{ "random_seed", "integer"}
 	};
 	// add any user-specified parameters as headers
 	for (String name : sessConfig->logger.sessParamsToLog) { sessColumns.append({ "'" + name + "'", "text", "NOT NULL" }); }
@@ -74,7 +75,8 @@ void Logger::createResultsFile(const String& filename,
 		"'" + sessConfig->id + "'",
 		"'" + timeStr + "'",
 		"'" + subjectID + "'",
-		"'" + description + "'"
+		"'" + description + "'",
+		String(std::to_string(sessConfig->randomSeed))
 	};
 	// Create any table to do lookup here
 	Any a = sessConfig->toAny(true);
@@ -120,6 +122,24 @@ void Logger::createResultsFile(const String& filename,
 	};
 	createTableInDB(m_db, "Trials", trialColumns);
 
+	// 3b. Trial_Stats, per-trial statistics computed during the trial
+	Columns trialStatsColumns = {
+			{ "trial_number", "integer" },
+			{ "trial_id", "integer" },
+			{ "session_id", "text" },
+			{ "shots", "integer" },
+			{ "hits", "integer" },
+			{ "misses", "integer" },
+			{ "kills", "integer" },
+			{ "targets_hit", "integer" },
+			{ "accuracy", "real" },
+			{ "hits_per_target", "real" },
+			{ "first_hit_time", "real" },
+			{ "first_kill_time", "real" },
+			{ "mean_kill_time", "real" }
+	};
+	createTableInDB(m_db, "Trial_Stats", trialStatsColumns);
+
 	// 4. Target_Trajectory, only need to create the table.
 	Columns targetTrajectoryColumns = {
 			{ "time", "text" },
@@ -146,8 +166,15 @@ void Logger::createResultsFile(const String& filename,
 	// 6. Frame_Info, create the table
 	Columns frameInfoColumns = {
 			{"time", "text"},
-			//{"idt", "real"},
+			{"rdt", "real"},
 			{"sdt", "real"},
+			{"idt", "real"},
+			{"user_input", "real"},
+			{"simulation", "real"},
+			{"pose", "real"},
+			{"wait", "real"},
+			{"graphics", "real"},
+			{"over_wait", "real"},
 	};
 	createTableInDB(m_db, "Frame_Info", frameInfoColumns);
 
@@ -175,15 +202,82 @@ void Logger::createResultsFile(const String& filename,
 		{"turnScaleY", "real"}
 	};
 	createTableInDB(m_db, "Users", userColumns);
+
+	//9. Raw mouse input events
+	Columns rawInputColumns = {
+		{"time", "text"},
+		{"dx", "integer"},
+		{"dy", "integer"},
+		{"buttons", "integer"},
+		{"wheel", "integer"}
+	};
+	createTableInDB(m_db, "Raw_Input", rawInputColumns);
+
+	//10. Presentation state timeline
+	Columns stateTimelineColumns = {
+		{"time", "text"},
+		{"timeline_ns", "integer"},
+		{"sim_time", "real"},
+		{"frame", "integer"},
+		{"trial_id", "integer"},
+		{"from_state", "text"},
+		{"to_state", "text"}
+	};
+	createTableInDB(m_db, "State_Timeline", stateTimelineColumns);
+
+	//11. Trial plan (compiled at session start)
+	Columns trialPlanColumns = {
+		{"trial_number", "integer"},
+		{"trial_id", "integer"},
+		{"target_idx", "integer"},
+		{"target_id", "text"},
+		{"pitch", "real"},
+		{"yaw", "real"},
+		{"spawn_x", "real"},
+		{"spawn_y", "real"},
+		{"spawn_z", "real"},
+		{"size", "real"},
+		{"scale_idx", "integer"},
+		{"rng_counter", "integer"}
+	};
+	createTableInDB(m_db, "Trial_Plan", trialPlanColumns);
+
+	//12. Per-frame aim error
+	Columns aimErrorColumns = {
+		{"time", "text"},
+		{"target_count", "integer"},
+		{"nearest_target", "text"},
+		{"nearest_error", "real"},
+		{"mean_error", "real"}
+	};
+	createTableInDB(m_db, "Aim_Error", aimErrorColumns);
+
+	//13. Baked target trajectories (keyframes)
+	Columns bakedTrajectoryColumns = {
+		{"spawn_time", "text"},
+		{"target_id", "text"},
+		{"t", "real"},
+		{"position_x", "real"},
+		{"position_y", "real"},
+		{"position_z", "real"}
+	};
+	createTableInDB(m_db, "Baked_Trajectory", bakedTrajectoryColumns);
 }
 
 void Logger::recordFrameInfo(const Array<FrameInfo>& frameInfo) {
 	Array<RowEntry> rows;
-	for (FrameInfo info : frameInfo) {
+	for (const FrameInfo& info : frameInfo) {
 		Array<String> frameValues = {
 			"'" + Logger::formatFileTime(info.time) + "'",
-			//String(std::to_string(info.idt)),
-			String(std::to_string(info.sdt))
+			String(std::to_string(info.rdt)),
+			String(std::to_string(info.sdt)),
+			String(std::to_string(info.idt)),
+			String(std::to_string(info.userInputDuration)),
+			String(std::to_string(info.simulationDuration)),
+			String(std::to_string(info.poseDuration)),
+			String(std::to_string(info.waitDuration)),
+			String(std::to_string(info.graphicsDuration)),
+			String(std::to_string(info.overWait))
 		};
 		rows.append(frameValues);
 	}
@@ -217,6 +311,95 @@ void Logger::recordPlayerActions(const Array<PlayerAction>& actions) {
 	insertRowsIntoDB(m_db, "Player_Action", rows);
 }
 
+void Logger::recordRawInput(const Array<RawInputEvent>& events) {
+	Array<RowEntry> rows;
+	for (const RawInputEvent& e : events) {
+		Array<String> rawInputValues = {
+			"'" + Logger::formatFileTime(e.time) + "'",
+			String(std::to_string(e.dx)),
+			String(std::to_string(e.dy)),
+			String(std::to_string(e.buttonFlags)),
+			String(std::to_string(e.wheel))
+		};
+		rows.append(rawInputValues);
+	}
+	insertRowsIntoDB(m_db, "Raw_Input", rows);
+}
+
+void Logger::recordStateTransitions(const Array<StateTransition>& transitions) {
+	Array<RowEntry> rows;
+	for (const StateTransition& t : transitions) {
+		Array<String> transitionValues = {
+			"'" + Logger::formatFileTime(t.time) + "'",
+			String(std::to_string(t.timelineNs)),
+			String(std::to_string(t.simTime)),
+			String(std::to_string(t.frame)),
+			String(std::to_string(t.trialIdx)),
+			"'" + t.fromState + "'",
+			"'" + t.toState + "'"
+		};
+		rows.append(transitionValues);
+	}
+	insertRowsIntoDB(m_db, "State_Timeline", rows);
+}
+
+void Logger::recordAimErrors(const Array<AimError>& errors) {
+	Array<RowEntry> rows;
+	for (const AimError& e : errors) {
+		Array<String> aimErrorValues = {
+			"'" + Logger::formatFileTime(e.time) + "'",
+			String(std::to_string(e.targetCount)),
+			"'" + e.nearestTarget + "'",
+			String(std::to_string(e.nearestError)),
+			String(std::to_string(e.meanError))
+		};
+		rows.append(aimErrorValues);
+	}
+	insertRowsIntoDB(m_db, "Aim_Error", rows);
+}
+
+void Logger::logBakedTrajectory(const String& name, const FILETIME& spawnTime, const Array<Destination>& path, const Vector3& offset) {
+	const String spawnTimeStr = "'" + Logger::formatFileTime(spawnTime) + "'";
+	Array<RowEntry> rows;
+	for (const Destination& d : path) {
+		const Point3 pos = d.position + offset;
+		rows.append(RowEntry({
+			spawnTimeStr,
+			"'" + name + "'",
+			String(std::to_string(d.time)),
+			String(std::to_string(pos.x)),
+			String(std::to_string(pos.y)),
+			String(std::to_string(pos.z))
+		}));
+	}
+	addToQueue(m_bakedTrajectories, rows);
+}
+
+void Logger::logTrialPlan(const TrialPlan& plan, int first) {
+	Array<RowEntry> rows;
+	for (int n = first; n < plan.size(); n++) {
+		const PlannedTrial& trial = plan[n];
+		for (int i = 0; i < trial.targets.size(); i++) {
+			const PlannedTarget& t = trial.targets[i];
+			rows.append(RowEntry({
+				String(std::to_string(n)),
+				String(std::to_string(trial.trialIdx)),
+				String(std::to_string(i)),
+				"'" + t.id + "'",
+				String(std::to_string(t.pitch)),
+				String(std::to_string(t.yaw)),
+				String(std::to_string(t.spawnPos.x)),
+				String(std::to_string(t.spawnPos.y)),
+				String(std::to_string(t.spawnPos.z)),
+				String(std::to_string(t.size)),
+				String(std::to_string(t.scaleIdx)),
+				String(std::to_string(t.rngCounter))
+			}));
+		}
+	}
+	addToQueue(m_trialPlan, rows);
+}
+
 void Logger::recordTargetLocations(const Array<TargetLocation>& locations) {
 	Array<RowEntry> rows;
 	for (const auto& loc : locations) {
@@ -252,6 +435,18 @@ void Logger::loggerThreadEntry()
 		playerActions.swap(m_playerActions, playerActions);
 		m_playerActions.reserve(playerActions.size() * 2);
 
+		decltype(m_rawInput) rawInput;
+		rawInput.swap(m_rawInput, rawInput);
+		m_rawInput.reserve(rawInput.size() * 2);
+
+		decltype(m_stateTransitions) stateTransitions;
+		stateTransitions.swap(m_stateTransitions, stateTransitions);
+		m_stateTransitions.reserve(stateTransitions.size() * 2);
+
+		decltype(m_aimErrors) aimErrors;
+		aimErrors.swap(m_aimErrors, aimErrors);
+		m_aimErrors.reserve(aimErrors.size() * 2);
+
 		decltype(m_questions) questions;
 		questions.swap(m_questions, questions);
 		m_questions.reserve(questions.size() * 2);
@@ -268,6 +463,18 @@ void Logger::loggerThreadEntry()
 		trials.swap(m_trials, trials);
 		m_trials.reserve(trials.size() * 2);
 
+		decltype(m_trialStats) trialStats;
+		trialStats.swap(m_trialStats, trialStats);
+		m_trialStats.reserve(trialStats.size() * 2);
+
+		decltype(m_trialPlan) trialPlan;
+		trialPlan.swap(m_trialPlan, trialPlan);
+		m_trialPlan.reserve(trialPlan.size() * 2);
+
+		decltype(m_bakedTrajectories) bakedTrajectories;
+		bakedTrajectories.swap(m_bakedTrajectories, bakedTrajectories);
+		m_bakedTrajectories.reserve(bakedTrajectories.size() * 2);
+
 		decltype(m_users) users;
 		users.swap(m_users, users);
 		m_users.reserve(users.size() * 2);
@@ -277,12 +484,18 @@ void Logger::loggerThreadEntry()
 
 		recordFrameInfo(frameInfo);
 		recordPlayerActions(playerActions);
+		recordRawInput(rawInput);
+		recordStateTransitions(stateTransitions);
+		recordAimErrors(aimErrors);
 		recordTargetLocations(targetLocations);
 
 		insertRowsIntoDB(m_db, "Questions", questions);
 		insertRowsIntoDB(m_db, "Targets", targets);
 		insertRowsIntoDB(m_db, "Users", users);
 		insertRowsIntoDB(m_db, "Trials", trials);
+		insertRowsIntoDB(m_db, "Trial_Stats", trialStats);
+		insertRowsIntoDB(m_db, "Trial_Plan", trialPlan);
+		insertRowsIntoDB(m_db, "Baked_Trajectory", bakedTrajectories);
 
 		lk.lock();
 	}
@@ -330,7 +543,7 @@ void Logger::flush(bool blockUntilDone)
 	m_queueCV.notify_one();
 }
 
-void Logger::addTarget(String name, shared_ptr<TargetConfig> config, float refreshRate, int addedFrameLag) {
+void Logger::addTarget(String name, shared_ptr<const TargetConfig> config, float refreshRate, int addedFrameLag) {
 	const String type = (config->destinations.size() > 0) ? "waypoint" : "parametrized";
 	const String jumpEnabled = config->jumpEnabled ? "True" : "False";
 	const String modelName = config->modelSpec["filename"];
@@ -2,6 +2,9 @@
 #include <G3D/G3D.h>
 #include "sqlHelpers.h"
 #include "ConfigFiles.h"
+#include "RawInputCapture.h"
+#include "AimError.h"
+#include "TrialPlan.h"
 
 using RowEntry = Array<String>;
 using Columns = Array<Array<String>>;
@@ -9,6 +12,7 @@ using Columns = Array<Array<String>>;
 struct TargetLocation;
 struct PlayerAction;
 struct FrameInfo;
+struct StateTransition;
 
 template<typename ItemType> static size_t queueBytes(Array<ItemType>& queue)
 {
@@ -37,20 +41,32 @@ protected:
 	// Output queues for reported data storage
 	Array<FrameInfo> m_frameInfo;						///< Storage for frame info (sdt, idt, rdt)
 	Array<PlayerAction> m_playerActions;				///< Storage for player action (hit, miss, aim)
+	Array<RawInputEvent> m_rawInput;					///< Storage for raw mouse input events
+	Array<StateTransition> m_stateTransitions;			///< Storage for presentation state transitions
+	Array<AimError> m_aimErrors;						///< Storage for per-frame aim error
 	Array<QuestionResult> m_questions;
 	Array<TargetLocation> m_targetLocations;			///< Storage for target trajectory (vector3 cartesian)
 	Array<TargetInfo> m_targets;
 	Array<TrialValues> m_trials;						///< Trial ID, start/end time etc.
+	Array<TrialValues> m_trialStats;					///< Per-trial statistics (shots, hits, kill times)
+	Array<RowEntry> m_trialPlan;						///< Planned trials (one row per target)
+	Array<RowEntry> m_bakedTrajectories;				///< Baked target paths (one row per keyframe)
 	Array<UserValues> m_users;
 
 	size_t getTotalQueueBytes()
 	{
 		return queueBytes(m_frameInfo) +
 			queueBytes(m_playerActions) +
+			queueBytes(m_rawInput) +
+			queueBytes(m_stateTransitions) +
+			queueBytes(m_aimErrors) +
 			queueBytes(m_questions) +
 			queueBytes(m_targetLocations) +
 			queueBytes(m_targets) +
-			queueBytes(m_trials);
+			queueBytes(m_trials) +
+			queueBytes(m_trialStats) +
+			queueBytes(m_trialPlan) +
+			queueBytes(m_bakedTrajectories);
 	}
 
 	template<typename ItemType> void addToQueue(Array<ItemType>& queue, const ItemType& item)
@@ -67,6 +83,19 @@ protected:
 		}
 	}
 
+	template<typename ItemType> void addToQueue(Array<ItemType>& queue, const Array<ItemType>& items)
+	{
+		{
+			std::lock_guard<std::mutex> lk(m_queueMutex);
+			queue.append(items);
+		}
+
+		size_t pendingBytes = getTotalQueueBytes();
+		if (pendingBytes >= m_bufferLimit) {
+			m_queueCV.notify_one();
+		}
+	}
+
 	void loggerThreadEntry();
 
 	/** Record an array of frame timing info */
@@ -75,6 +104,15 @@ protected:
 	/** Record an array of player actions */
 	void recordPlayerActions(const Array<PlayerAction>& actions);
 
+	/** Record an array of raw mouse input events */
+	void recordRawInput(const Array<RawInputEvent>& events);
+
+	/** Record an array of presentation state transitions */
+	void recordStateTransitions(const Array<StateTransition>& transitions);
+
+	/** Record an array of per-frame aim errors */
+	void recordAimErrors(const Array<AimError>& errors);
+
 	/** Record an array of target locations */
 	void recordTargetLocations(const Array<TargetLocation>& locations);
 
@@ -102,13 +140,29 @@ public:
 
 	void logFrameInfo(const FrameInfo& frameInfo) { addToQueue(m_frameInfo, frameInfo); }
 	void logPlayerAction(const PlayerAction& playerAction) { addToQueue(m_playerActions, playerAction); }
+	void logRawInput(const Array<RawInputEvent>& events) { addToQueue(m_rawInput, events); }
+	void logStateTransition(const StateTransition& transition) { addToQueue(m_stateTransitions, transition); }
+	void logAimError(const AimError& error) { addToQueue(m_aimErrors, error); }
 	void logQuestionResult(const QuestionResult& questionResult) { addToQueue(m_questions, questionResult); }
 	void logTargetLocation(const TargetLocation& targetLocation) { addToQueue(m_targetLocations, targetLocation); }
 	void logTargetInfo(const TargetInfo& targetInfo) { addToQueue(m_targets, targetInfo); }
 	void logTrial(const TrialValues& trial) { addToQueue(m_trials, trial); }
+	void logTrialStats(const TrialValues& stats) { addToQueue(m_trialStats, stats); }
+
+	/** Log a baked target path (keyframe times are relative to spawnTime, positions are offset by offset) */
+	void logBakedTrajectory(const String& name, const FILETIME& spawnTime, const Array<Destination>& path, const Vector3& offset);
+
+	/** Log planned trials [first, plan.size()) to the Trial_Plan table */
+	void logTrialPlan(const TrialPlan& plan, int first = 0);
 
 	void logUserConfig(const UserConfig& userConfig, const String session_ref, const String position);
 
+	/** Bytes currently waiting in the output queues (for monitoring) */
+	size_t queuedBytes() {
+		std::lock_guard<std::mutex> lk(m_queueMutex);
+		return getTotalQueueBytes();
+	}
+
 	/** Wakes up the logging thread and flushes even if the buffer limit is not reached yet. */
 	void flush(bool blockUntilDone);
 	
@@ -125,5 +179,5 @@ public:
 	void addQuestion(Question question, String session);
 
 	/** Add a target to an experiment */
-	void addTarget(String name, shared_ptr<TargetConfig> targetConfig, float refreshRate, int addedFrameLag);
+	void addTarget(String name, shared_ptr<const TargetConfig> targetConfig, float refreshRate, int addedFrameLag);
 };
@@ -0,0 +1,102 @@
+#include "ModelCache.h"
+
+ModelCache& ModelCache::common() {
+	static ModelCache cache;
+	return cache;
+}
+
+ModelCache::ModelCache() {
+	if (!FileSystem::exists(m_filename)) return;
+	try {
+		BinaryInput bi(m_filename, G3D_LITTLE_ENDIAN);
+		if (bi.readString32() != m_header || bi.readInt32() != m_version) {
+			logPrintf("Model cache %s is from another version, ignoring it\n", m_filename.c_str());
+			return;
+		}
+		const int count = bi.readInt32();
+		for (int i = 0; i < count; i++) {
+			const String k = bi.readString32();
+			Point3 low, high;
+			low.deserialize(bi);
+			high.deserialize(bi);
+			m_bounds.set(k, AABox(low, high));
+		}
+	}
+	catch (...) {
+		logPrintf("Could not read model cache %s, ignoring it\n", m_filename.c_str());
+		m_bounds.clear();
+	}
+}
+
+String ModelCache::sourcePath(const Any& spec) {
+	if (spec.type() != Any::TABLE || !spec.containsKey("filename")) return "";
+	return System::findDataFile(spec["filename"].string(), false);
+}
+
+String ModelCache::makeKey(const String& specText, const String& sourcePath) {
+	uint64 hash = 14695981039346656037ull;			// FNV-1a
+	for (size_t i = 0; i < specText.size(); i++) {
+		hash ^= (uint8)specText[i];
+		hash *= 1099511628211ull;
+	}
+	uint64 time = 0;
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!sourcePath.empty() && GetFileAttributesExA(sourcePath.c_str(), GetFileExInfoStandard, &data)) {
+		time = (uint64(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+	}
+	return format("%016llx-%016llx", (unsigned long long)hash, (unsigned long long)time);
+}
+
+const String& ModelCache::key(const Any& spec) {
+	const String text = spec.unparse();
+	String* key = m_keys.getPointer(text);
+	if (isNull(key)) {
+		m_keys.set(text, makeKey(text, sourcePath(spec)));
+		key = m_keys.getPointer(text);
+	}
+	return *key;
+}
+
+void ModelCache::addBounds(const String& key, const shared_ptr<ArticulatedModel>& model) {
+	if (m_bounds.containsKey(key)) return;
+	AABox bbox;
+	model->getBoundingBox(bbox);
+	m_bounds.set(key, bbox);
+	m_dirty = true;
+}
+
+shared_ptr<ArticulatedModel> ModelCache::get(const Any& spec, const String& name) {
+	const String& k = key(spec);
+	shared_ptr<ArticulatedModel>* model = m_models.getPointer(k);
+	if (notNull(model)) return *model;
+
+	const shared_ptr<ArticulatedModel> m = ArticulatedModel::create(ArticulatedModel::Specification(spec), name);
+	m_models.set(k, m);
+	addBounds(k, m);
+	return m;
+}
+
+AABox ModelCache::bounds(const Any& spec) {
+	const String& k = key(spec);
+	const AABox* bbox = m_bounds.getPointer(k);
+	if (notNull(bbox)) return *bbox;
+
+	// Only the bounds are needed (e.g. a target's unscaled base model), so the model is released once it is measured
+	addBounds(k, ArticulatedModel::create(ArticulatedModel::Specification(spec)));
+	return m_bounds[k];
+}
+
+void ModelCache::save() {
+	if (!m_dirty) return;
+	BinaryOutput bo(m_filename, G3D_LITTLE_ENDIAN);
+	bo.writeString32(m_header);
+	bo.writeInt32(m_version);
+	bo.writeInt32(m_bounds.size());
+	for (const Table<String, AABox>::Entry& e : m_bounds) {
+		bo.writeString32(e.key);
+		e.value.low().serialize(bo);
+		e.value.high().serialize(bo);
+	}
+	bo.commit();
+	m_dirty = false;
+}
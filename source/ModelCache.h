@@ -0,0 +1,44 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Cache of loaded models and model bounds, keyed by a hash of the model specification and the modification time of its source file.
+	Every user of the same specification (e.g. the weapon view model, reloaded each session) shares one processed model.
+	Model bounds are persisted to a binary cache file, so warm starts can size targets without loading (parsing) their base models.
+	Loaded models hold GL resources, so the app drops them (clearModels()) during cleanup, before the GL context is destroyed. */
+class ModelCache {
+protected:
+	const String								m_filename = "modelCache.bin";		///< Binary cache file (bounds by key)
+	const String								m_header = "FPSciModelCache";
+	const int32									m_version = 1;
+
+	Table<String, String>						m_keys;				///< Cache key by specification text (so source files are only checked once)
+	Table<String, shared_ptr<ArticulatedModel>>	m_models;			///< Loaded models by key
+	Table<String, AABox>						m_bounds;			///< Model bounds by key (persisted)
+	bool										m_dirty = false;	///< Bounds have been added since the cache file was read
+
+	ModelCache();
+
+	/** Hash a specification and look up its source file's modification time */
+	static String makeKey(const String& specText, const String& sourcePath);
+	/** Resolve the source file of a specification (empty if there is none) */
+	static String sourcePath(const Any& spec);
+
+	const String& key(const Any& spec);
+	/** Store the bounds of a newly loaded model (if they are not already cached) */
+	void addBounds(const String& key, const shared_ptr<ArticulatedModel>& model);
+
+public:
+	static ModelCache& common();
+
+	/** Get the model for this specification, loading it if it is not already cached */
+	shared_ptr<ArticulatedModel> get(const Any& spec, const String& name = "");
+
+	/** Bounds of the model for this specification (from the cache file if present, otherwise the model is loaded to measure it, but not kept) */
+	AABox bounds(const Any& spec);
+
+	/** Write the bounds cache file (if anything was added) */
+	void save();
+
+	/** Drop all loaded models (keys and bounds are kept) */
+	void clearModels() { m_models.clear(); }
+};
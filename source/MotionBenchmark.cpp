@@ -0,0 +1,314 @@
+#include "MotionBenchmark.h"
+#include "TargetEntity.h"
+#include "TargetMotion.h"
+
+/** Distance from p to the box (0 when inside), optionally ignoring the vertical axis */
+static float outsideDistance(const AABox& box, const Point3& p, bool ignoreY = false) {
+	Vector3 d = (box.low() - p).max(Vector3::zero()) + (p - box.high()).max(Vector3::zero());
+	if (ignoreY) d.y = 0.0f;
+	return d.length();
+}
+
+/** FNV-1a hash of the target positions (bitwise, in target order) */
+static uint64 hashPositions(const Array<shared_ptr<TargetEntity>>& targets) {
+	uint64 hash = 14695981039346656037ull;
+	for (const shared_ptr<TargetEntity>& target : targets) {
+		const Point3& p = target->frame().translation;
+		for (int a = 0; a < 3; a++) {
+			uint32 bits;
+			memcpy(&bits, &p[a], sizeof(bits));
+			for (int b = 0; b < 4; b++) {
+				hash ^= (bits >> (8 * b)) & 0xFF;
+				hash *= 1099511628211ull;
+			}
+		}
+	}
+	return hash;
+}
+
+bool MotionBenchmark::requested(int argc, const char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (String(argv[i]) == "--motion-benchmark") return true;
+	}
+	return false;
+}
+
+MotionBenchmark::Settings MotionBenchmark::parseArgs(int argc, const char* argv[]) {
+	Settings s;
+	for (int i = 1; i < argc; i++) {
+		const String arg = argv[i];
+		const bool hasValue = (i + 1) < argc;
+		if (arg == "--model" && hasValue)			{ s.model = argv[++i]; }
+		else if (arg == "--targets" && hasValue)	{ s.targets = atoi(argv[++i]); }
+		else if (arg == "--steps" && hasValue)		{ s.steps = atoi(argv[++i]); }
+		else if (arg == "--dt" && hasValue)			{ s.timestep = (SimTime)atof(argv[++i]); }
+		else if (arg == "--seed" && hasValue)		{ s.seed = uint32(atoi(argv[++i])); }
+		else if (arg == "--threads" && hasValue)	{ s.threads = atoi(argv[++i]); }
+	}
+	if (s.threads < 0) s.threads = (int)std::thread::hardware_concurrency();
+	alwaysAssertM(s.timestep > 0.0f, "Benchmark timestep must be positive!");
+	alwaysAssertM(s.targets > 0 && s.steps > 0, "Benchmark target and step counts must be positive!");
+	return s;
+}
+
+Array<MotionBenchmark::Case> MotionBenchmark::cases() {
+	const AABox moveBounds(Point3(-10.0f, 0.0f, -10.0f), Point3(10.0f, 5.0f, 10.0f));
+	const AABox spawnBounds(Point3(-5.0f, 1.0f, -5.0f), Point3(5.0f, 4.0f, 5.0f));
+	Array<Case> cases;
+
+	// Waypoint paths (a closed loop, the last destination repeats the first)
+	for (const String interpolation : { "linear", "catmullrom" }) {
+		shared_ptr<TargetConfig> config = createShared<TargetConfig>();
+		config->id = "waypoint_" + interpolation;
+		config->destSpace = "world";
+		config->pathInterpolation = interpolation;
+		for (int i = 0; i <= 8; i++) {
+			const float angle = 2.0f * pif() * float(i % 8) / 8.0f;
+			config->destinations.append(Destination(Point3(10.0f * cos(angle), 2.0f + float(i % 2), 10.0f * sin(angle)), 0.5f * i));
+		}
+		cases.append(Case{ "waypoint/" + interpolation, Model::Waypoint, config });
+	}
+
+	// Flying targets
+	shared_ptr<TargetConfig> flying = createShared<TargetConfig>();
+	flying->id = "flying_player";
+	flying->destSpace = "player";
+	flying->speed = { 5.0f, 30.0f };
+	flying->motionChangePeriod = { 0.2f, 1.0f };
+	cases.append(Case{ "flying/player", Model::Flying, flying });
+
+	shared_ptr<TargetConfig> upper = createShared<TargetConfig>(*flying);
+	upper->id = "flying_player_upper";
+	upper->upperHemisphereOnly = true;
+	upper->eccV = { 0.0f, 30.0f };
+	cases.append(Case{ "flying/player/upper", Model::Flying, upper });
+
+	shared_ptr<TargetConfig> flyingWorld = createShared<TargetConfig>(*flying);
+	flyingWorld->id = "flying_world";
+	flyingWorld->destSpace = "world";
+	flyingWorld->speed = { 1.0f, 5.0f };
+	flyingWorld->spawnBounds = spawnBounds;
+	flyingWorld->moveBounds = moveBounds;
+	cases.append(Case{ "flying/world", Model::Flying, flyingWorld });
+	cases.append(Case{ "flying/world/batched", Model::Flying, flyingWorld, true, "flying/world" });
+
+	// Jumping targets
+	shared_ptr<TargetConfig> jumping = createShared<TargetConfig>();
+	jumping->id = "jumping_player";
+	jumping->destSpace = "player";
+	jumping->jumpEnabled = true;
+	jumping->speed = { 5.0f, 30.0f };
+	jumping->motionChangePeriod = { 0.2f, 1.0f };
+	jumping->jumpPeriod = { 0.2f, 0.5f };
+	cases.append(Case{ "jumping/player", Model::Jumping, jumping });
+
+	shared_ptr<TargetConfig> jumpingWorld = createShared<TargetConfig>(*jumping);
+	jumpingWorld->id = "jumping_world";
+	jumpingWorld->destSpace = "world";
+	jumpingWorld->speed = { 1.0f, 5.0f };
+	jumpingWorld->spawnBounds = spawnBounds;
+	jumpingWorld->moveBounds = moveBounds;
+	cases.append(Case{ "jumping/world", Model::Jumping, jumpingWorld });
+
+	return cases;
+}
+
+const MotionBenchmark::Case* MotionBenchmark::findCase(const Array<Case>& cases, const String& name) {
+	for (const Case& c : cases) {
+		if (c.name == name) return &c;
+	}
+	return nullptr;
+}
+
+void MotionBenchmark::runCase(const Case& c, const Settings& settings, int threads, Result& result) {
+	const shared_ptr<const TargetConfig>& config = c.config;
+	const bool isWorldSpace = config->destSpace == "world";
+	const Point3 playerPos = Point3::zero();
+	const float targetDistance = 10.0f;
+	const SimTime dt = settings.timestep;
+	const float boundsSlack = 2.0f * config->speed[1] * float(dt) + 1e-4f;		// Targets reflect only once they have left the bounds
+
+	TargetWorkerPool motionWorkers;
+	motionWorkers.start(threads);
+	WorldMotionBatch worldMotion;
+
+	// Spawn targets (no scene or model, matches HeadlessDriver)
+	Array<shared_ptr<TargetEntity>> targets;
+	Array<shared_ptr<JumpingEntity>> jumpers;
+	for (int i = 0; i < settings.targets; i++) {
+		CounterRandom rng(settings.seed, CounterRandom::targetStream(0, i));
+		const float pitch = rng.sign() * rng.uniform(config->eccV[0], config->eccV[1]);
+		const float yaw = rng.sign() * rng.uniform(config->eccH[0], config->eccH[1]);
+		const CFrame f = CFrame::fromXYZYPRDegrees(playerPos.x, playerPos.y, playerPos.z, yaw, pitch, 0.0f);
+		const String name = format("%s_%d", config->id.c_str(), i);
+		const Point3 playerSpacePos = f.pointToWorldSpace(Point3(0, 0, -targetDistance));
+
+		shared_ptr<TargetEntity> target;
+		Point3 pos;
+		if (c.model == Model::Waypoint) {
+			pos = Point3::zero();
+			target = TargetEntity::create(config, name, nullptr, nullptr, pos, 0, i, rng);
+		}
+		else if (c.model == Model::Jumping) {
+			pos = isWorldSpace ? rng.randomInteriorPoint(config->spawnBounds) : playerSpacePos;
+			shared_ptr<JumpingEntity> t = JumpingEntity::create(config, name, nullptr, nullptr, 0, playerPos, targetDistance, i, rng);
+			t->setWorldSpace(isWorldSpace);
+			if (isWorldSpace) t->setMoveBounds(config->moveBounds);
+			jumpers.append(t);
+			target = t;
+		}
+		else {
+			pos = isWorldSpace ? rng.randomInteriorPoint(config->spawnBounds) : playerSpacePos;
+			shared_ptr<FlyingEntity> t = FlyingEntity::create(config, name, nullptr, nullptr, playerPos, 0, i, rng);
+			t->setWorldSpace(isWorldSpace);
+			if (isWorldSpace) t->setBounds(config->moveBounds);
+			target = t;
+		}
+		target->setFrame(pos);
+		target->setExternalMotion(motionWorkers.enabled());
+		targets.append(target);
+		if (c.batched) {
+			worldMotion.add(std::static_pointer_cast<FlyingEntity>(target));
+		}
+	}
+
+	Invariant radius("orbit radius");
+	Invariant hemisphere("upper hemisphere");
+	Invariant bounds("move bounds");
+	Invariant landing("jump landing height");
+	Invariant passThrough("waypoint pass-through");
+	Invariant prediction("one step prediction");
+	Array<Point3> predicted;
+	Array<bool> isPredicted;
+	predicted.resize(targets.size());
+	isPredicted.resize(targets.size());
+	Array<bool> wasInJump;
+	wasInJump.resize(jumpers.size());
+	for (bool& inJump : wasInJump) inJump = false;
+
+	SimTime time = 0;
+	for (int step = 0; step < settings.steps; step++) {
+		time += dt;
+
+		// Predict this step (when it is within the targets' prediction horizons)
+		for (int i = 0; i < targets.size(); i++) {
+			isPredicted[i] = targets[i]->predictionHorizon() >= time;
+			if (isPredicted[i]) predicted[i] = targets[i]->predictPosition(time);
+		}
+
+		const RealTime t0 = System::time();
+		for (const shared_ptr<TargetEntity>& target : targets) {
+			target->onSimulation(time, dt);
+		}
+		if (motionWorkers.enabled()) {
+			motionWorkers.simulate(targets, time, dt);
+		}
+		worldMotion.simulate(time, dt);
+		result.simulation += System::time() - t0;
+
+		// Check invariants (untimed)
+		for (int i = 0; i < targets.size(); i++) {
+			const Point3& pos = targets[i]->frame().translation;
+			if (isPredicted[i]) {
+				prediction.check((pos - predicted[i]).length(), 1e-4f);
+			}
+			if (c.model == Model::Flying) {
+				if (isWorldSpace) {
+					bounds.check(outsideDistance(config->moveBounds, pos), boundsSlack);
+				}
+				else {
+					radius.check(abs((pos - playerPos).length() - targetDistance) / targetDistance, 1e-4f);
+					if (config->upperHemisphereOnly) {
+						hemisphere.check(max(0.0f, playerPos.y - pos.y) / targetDistance, 1e-5f);
+					}
+				}
+			}
+			else if (c.model == Model::Jumping) {
+				const shared_ptr<JumpingEntity>& jumper = jumpers[i];
+				if (isWorldSpace) {
+					bounds.check(outsideDistance(config->moveBounds, pos, true), boundsSlack);		// Jumps may leave the bounds vertically
+				}
+				else {
+					radius.check(abs((pos - jumper->orbitCenter()).length() - jumper->orbitRadius()) / jumper->orbitRadius(), 1e-4f);
+				}
+				if (wasInJump[i] && !jumper->inJump()) {
+					const float height = isWorldSpace ? pos.y : jumper->simulatedPosition().y;
+					landing.check(abs(height - jumper->standingHeight()), 1e-4f);
+				}
+				wasInJump[i] = jumper->inJump();
+			}
+		}
+	}
+	result.checksum = hashPositions(targets);
+
+	if (c.model == Model::Waypoint) {
+		for (const shared_ptr<TargetEntity>& target : targets) {
+			for (const Destination& d : config->destinations) {
+				passThrough.check((target->pathPosition(d.time) - d.position).length(), 1e-4f);
+			}
+		}
+	}
+
+	for (const Invariant& inv : { radius, hemisphere, bounds, landing, passThrough, prediction }) {
+		if (inv.checks > 0) result.invariants.append(inv);
+	}
+}
+
+int MotionBenchmark::run(const Settings& settings) {
+	printf("Motion benchmark: %d targets x %d steps, dt = %0.3fms, seed %u\n",
+		settings.targets, settings.steps, 1e3f * settings.timestep, settings.seed);
+
+	const double targetSteps = double(settings.targets) * double(settings.steps);
+	bool failed = false;
+	int ran = 0;
+	const Array<Case> allCases = cases();
+	Table<String, uint64> checksums;		// Serial checksums by case name
+	for (const Case& c : allCases) {
+		if (!settings.model.empty() && settings.model != c.name) continue;
+		ran++;
+
+		Result serial;
+		runCase(c, settings, 0, serial);
+		String msg = format("[%s] %0.1f ns/target/step, checksum %016llx\n", c.name.c_str(), 1e9 * serial.simulation / targetSteps, (unsigned long long)serial.checksum);
+		for (const Invariant& inv : serial.invariants) {
+			msg += format("\t%s: %d checks, %d violations (max error %g)%s\n", inv.name.c_str(), inv.checks, inv.violations, inv.maxError, (inv.violations > 0) ? " FAILED" : "");
+			failed = failed || (inv.violations > 0);
+		}
+
+		checksums.set(c.name, serial.checksum);
+
+		// An alternate implementation must reproduce its reference model's results exactly (the reference is run here if it was skipped)
+		if (!c.reference.empty()) {
+			if (!checksums.containsKey(c.reference)) {
+				const Case* reference = findCase(allCases, c.reference);
+				alwaysAssertM(notNull(reference), format("Unknown reference case \"%s\"!", c.reference.c_str()));
+				Result r;
+				runCase(*reference, settings, 0, r);
+				checksums.set(c.reference, r.checksum);
+			}
+			const bool match = checksums[c.reference] == serial.checksum;
+			msg += format("\tresults %s %s\n", match ? "match" : "differ from", (c.reference + (match ? "" : " FAILED")).c_str());
+			failed = failed || !match;
+		}
+
+		// Parallel motion must reproduce the serial results exactly
+		if (settings.threads > 1) {
+			Result parallel;
+			runCase(c, settings, settings.threads, parallel);
+			const bool match = parallel.checksum == serial.checksum;
+			msg += format("\t%d threads: %0.1f ns/target/step (%0.2fx), results %s\n", settings.threads,
+				1e9 * parallel.simulation / targetSteps, serial.simulation / max(parallel.simulation, 1e-9), match ? "match" : "differ FAILED");
+			failed = failed || !match;
+		}
+
+		printf("%s", msg.c_str());
+		logPrintf("%s", msg.c_str());
+	}
+
+	if (ran == 0) {
+		printf("Motion model \"%s\" not found, models are:\n", settings.model.c_str());
+		for (const Case& c : allCases) printf("\t%s\n", c.name.c_str());
+		return -1;
+	}
+	return failed ? 1 : 0;
+}
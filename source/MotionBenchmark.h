@@ -0,0 +1,71 @@
+#pragma once
+#include <G3D/G3D.h>
+#include "ConfigFiles.h"
+
+/** Runs each target motion model (waypoint, flying and jumping, in player and world space) over many targets
+	and timesteps from fixed seeds, reporting the cost (ns/target/step), a checksum of the final positions and
+	any violated motion invariants (orbit radius, move bounds, upper hemisphere, jump landing height).
+	Alternate implementations of a model (e.g. batched world space motion) must reproduce its checksum.
+	Comparing checksums between builds shows whether a motion optimization changed behavior.
+
+	Run as: FirstPersonScience.exe --motion-benchmark [--model name] [--targets n] [--steps n] [--dt seconds] [--seed n] [--threads n]
+*/
+class MotionBenchmark {
+public:
+	struct Settings {
+		String		model = "";					///< Motion model to run (empty for all models)
+		int			targets = 1000;				///< Targets per model
+		int			steps = 5000;				///< Timesteps per model
+		SimTime		timestep = 0.001f;			///< Fixed simulation timestep (s)
+		uint32		seed = 1;					///< Seed for all target random streams
+		int			threads = 0;				///< Also run on a TargetWorkerPool w/ this many threads and compare results (0/1 to skip)
+	};
+
+	/** A checked motion property (error is compared against a tolerance every time it is checked) */
+	struct Invariant {
+		String		name;
+		int			checks = 0;
+		int			violations = 0;
+		float		maxError = 0.0f;
+
+		Invariant(const String& name = "") : name(name) {}
+
+		void check(float error, float tolerance) {
+			checks++;
+			maxError = max(maxError, error);
+			if (!(error <= tolerance)) violations++;			// NaN errors are violations
+		}
+	};
+
+	/** Returns true if the command line requests a motion benchmark run */
+	static bool requested(int argc, const char* argv[]);
+
+	/** Parse settings from the command line */
+	static Settings parseArgs(int argc, const char* argv[]);
+
+	/** Run the benchmark, returns a process exit code (non-zero if any invariant was violated) */
+	static int run(const Settings& settings);
+
+protected:
+	enum class Model { Waypoint, Flying, Jumping };
+
+	/** A motion model to benchmark */
+	struct Case {
+		String								name;
+		Model								model;
+		shared_ptr<const TargetConfig>		config;
+		bool								batched = false;	///< Simulate world space flying targets in a WorldMotionBatch
+		String								reference = "";		///< Case whose (serial) results this case must reproduce exactly (if any)
+	};
+
+	/** Results of running a case */
+	struct Result {
+		RealTime				simulation = 0.0;		///< Wall clock time spent in target motion (s)
+		uint64					checksum = 0;			///< Hash of the final target positions
+		Array<Invariant>		invariants;
+	};
+
+	static Array<Case> cases();
+	static const Case* findCase(const Array<Case>& cases, const String& name);
+	static void runCase(const Case& c, const Settings& settings, int threads, Result& result);
+};
@@ -0,0 +1,136 @@
+#include "RawInputCapture.h"
+#include "Logger.h"
+
+RawInputCapture::RawInputCapture() {
+	m_ring.resize(m_capacity);
+	m_running = true;
+	m_thread = std::thread(&RawInputCapture::threadEntry, this);
+}
+
+RawInputCapture::~RawInputCapture() {
+	// The capture thread may not have created its message queue yet, keep posting until it accepts the quit
+	const DWORD threadId = GetThreadId((HANDLE)m_thread.native_handle());
+	while (m_running && !PostThreadMessage(threadId, WM_QUIT, 0, 0)) {
+		std::this_thread::yield();
+	}
+	m_thread.join();
+	if (m_dropped > 0) {
+		logPrintf("Raw input capture dropped %u events (buffer full)\n", (uint32)m_dropped);
+	}
+}
+
+void RawInputCapture::threadEntry() {
+	// Create a message-only window to receive WM_INPUT for this thread
+	HINSTANCE instance = GetModuleHandle(nullptr);
+	WNDCLASSEXA wc = {};
+	wc.cbSize = sizeof(wc);
+	wc.lpfnWndProc = &RawInputCapture::windowProc;
+	wc.hInstance = instance;
+	wc.lpszClassName = "FPSciRawInputCapture";
+	RegisterClassExA(&wc);		// Fails harmlessly if already registered by a previous session
+
+	m_hwnd = CreateWindowExA(0, wc.lpszClassName, "", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, instance, nullptr);
+	if (m_hwnd == nullptr) {
+		logPrintf("Raw input capture: could not create window, capture disabled\n");
+		m_running = false;
+		return;
+	}
+	SetWindowLongPtr(m_hwnd, GWLP_USERDATA, (LONG_PTR)this);
+
+	// Registrations are per process (one per device type), so ours replaces any existing mouse registration until shutdown
+	m_hadPreviousDevice = findMouseRegistration(m_previousDevice);
+
+	// Register for mouse raw input even while the app window has focus (legacy mouse messages are left in place)
+	RAWINPUTDEVICE rid;
+	rid.usUsagePage = 0x01;		// Generic desktop
+	rid.usUsage = 0x02;			// Mouse
+	rid.dwFlags = RIDEV_INPUTSINK;
+	rid.hwndTarget = m_hwnd;
+	if (!RegisterRawInputDevices(&rid, 1, sizeof(rid))) {
+		logPrintf("Raw input capture: could not register raw input device, capture disabled\n");
+		DestroyWindow(m_hwnd);
+		m_running = false;
+		return;
+	}
+
+	MSG msg;
+	while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+		DispatchMessage(&msg);
+	}
+
+	// Hand mouse raw input back to its previous target (if it still exists), otherwise remove our registration
+	if (m_hadPreviousDevice && (m_previousDevice.hwndTarget == nullptr || IsWindow(m_previousDevice.hwndTarget))) {
+		RegisterRawInputDevices(&m_previousDevice, 1, sizeof(m_previousDevice));
+	}
+	else {
+		rid.dwFlags = RIDEV_REMOVE;
+		rid.hwndTarget = nullptr;
+		RegisterRawInputDevices(&rid, 1, sizeof(rid));
+	}
+	DestroyWindow(m_hwnd);
+	m_running = false;
+}
+
+bool RawInputCapture::findMouseRegistration(RAWINPUTDEVICE& device) {
+	UINT count = 0;
+	if (GetRegisteredRawInputDevices(nullptr, &count, sizeof(RAWINPUTDEVICE)) == (UINT)-1 || count == 0) return false;
+	Array<RAWINPUTDEVICE> devices;
+	devices.resize(count);
+	count = GetRegisteredRawInputDevices(devices.getCArray(), &count, sizeof(RAWINPUTDEVICE));
+	if (count == (UINT)-1) return false;
+	for (UINT i = 0; i < count; i++) {
+		if (devices[i].usUsagePage == 0x01 && devices[i].usUsage == 0x02) {
+			device = devices[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+LRESULT CALLBACK RawInputCapture::windowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	if (msg == WM_INPUT) {
+		// Timestamp before doing any other work
+		const FILETIME time = Logger::getFileTime();
+
+		RAWINPUT raw;
+		UINT size = sizeof(raw);
+		RawInputCapture* capture = (RawInputCapture*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+		if (notNull(capture) && GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) != (UINT)-1 &&
+			raw.header.dwType == RIM_TYPEMOUSE)
+		{
+			const RAWMOUSE& mouse = raw.data.mouse;
+			RawInputEvent e;
+			e.time = time;
+			if (!(mouse.usFlags & MOUSE_MOVE_ABSOLUTE)) {
+				e.dx = mouse.lLastX;
+				e.dy = mouse.lLastY;
+			}
+			e.buttonFlags = mouse.usButtonFlags;
+			if (mouse.usButtonFlags & RI_MOUSE_WHEEL) {
+				e.wheel = (int16)mouse.usButtonData;
+			}
+			capture->push(e);
+		}
+	}
+	return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+void RawInputCapture::push(const RawInputEvent& e) {
+	const uint32 head = m_head.load(std::memory_order_relaxed);
+	if (head - m_tail.load(std::memory_order_acquire) >= m_capacity) {
+		m_dropped++;
+		return;
+	}
+	m_ring[head & (m_capacity - 1)] = e;
+	m_head.store(head + 1, std::memory_order_release);
+}
+
+int RawInputCapture::drain(Array<RawInputEvent>& events) {
+	const uint32 tail = m_tail.load(std::memory_order_relaxed);
+	const uint32 head = m_head.load(std::memory_order_acquire);
+	for (uint32 i = tail; i != head; i++) {
+		events.append(m_ring[i & (m_capacity - 1)]);
+	}
+	m_tail.store(head, std::memory_order_release);
+	return (int)(head - tail);
+}
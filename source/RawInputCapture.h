@@ -0,0 +1,50 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <atomic>
+
+/** A single raw mouse event, timestamped on arrival */
+struct RawInputEvent {
+	FILETIME time;
+	int32 dx = 0;					///< Relative X motion (mouse counts)
+	int32 dy = 0;					///< Relative Y motion (mouse counts)
+	uint16 buttonFlags = 0;			///< RI_MOUSE_* button transition flags
+	int16 wheel = 0;				///< Wheel delta (if RI_MOUSE_WHEEL is set)
+};
+
+/** Captures raw mouse input on a dedicated thread, independent of the frame loop.
+	Events are timestamped as they arrive and pushed into a single-producer/single-consumer
+	lock-free ring that the session drains once per frame. */
+class RawInputCapture : public ReferenceCountedObject {
+protected:
+	static const uint32 m_capacity = 1 << 16;		///< Ring capacity (power of 2, ~65s of 1kHz input)
+
+	Array<RawInputEvent> m_ring;					///< Ring storage (fixed size)
+	std::atomic<uint32> m_head{ 0 };				///< Next slot to write (producer owned)
+	std::atomic<uint32> m_tail{ 0 };				///< Next slot to read (consumer owned)
+	std::atomic<uint32> m_dropped{ 0 };				///< Events dropped because the ring was full
+
+	std::thread m_thread;
+	std::atomic<bool> m_running{ false };
+	HWND m_hwnd = nullptr;							///< Message-only window receiving WM_INPUT
+	RAWINPUTDEVICE m_previousDevice = {};			///< Mouse registration replaced by the capture window (restored on shutdown)
+	bool m_hadPreviousDevice = false;				///< Was there a mouse registration (e.g. the app window's) to restore?
+
+	void threadEntry();
+	void push(const RawInputEvent& e);
+	/** Find the process' current mouse raw input registration (if any), returns false if there is none */
+	static bool findMouseRegistration(RAWINPUTDEVICE& device);
+	static LRESULT CALLBACK windowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+public:
+	RawInputCapture();
+	virtual ~RawInputCapture();
+
+	static shared_ptr<RawInputCapture> create() {
+		return createShared<RawInputCapture>();
+	}
+
+	/** Move all pending events into events (appends), returns the number of events added */
+	int drain(Array<RawInputEvent>& events);
+
+	uint32 droppedCount() const { return m_dropped; }
+};
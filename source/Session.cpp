@@ -28,20 +28,32 @@
 #include "Session.h"
 #include "App.h"
 #include "Logger.h"
+#include "Telemetry.h"
+#include "RawInputCapture.h"
 #include "TargetEntity.h"
 #include "PlayerEntity.h"
 #include "Dialogs.h"
+#include "TrajectoryBaker.h"
 
 void Session::nextCondition() {
-	Array<int> unrunTrialIdxs;
-	for (int i = 0; i < m_remainingTrials.size(); i++) {
-		if (m_remainingTrials[i] > 0 || m_remainingTrials[i] == -1) {
-			unrunTrialIdxs.append(i);
+	// Sessions w/ infinite trials are planned incrementally, extend the plan if needed
+	if (!m_trialPlan.contains(m_trialNumber)) {
+		m_trialPlan.compile(m_trialNumber + m_trialPlanHorizon);
+		logTrialPlan();
+	}
+	if (!m_trialPlan.contains(m_trialNumber)) return;		// No trials remaining
+	m_currTrialIdx = m_trialPlan[m_trialNumber].trialIdx;
+}
+
+void Session::logTrialPlan() {
+	if (m_loggedPlanTrials == m_trialPlan.size()) return;
+	if (notNull(m_logger) && m_config->logger.logTrialPlan) {
+		m_logger->logTrialPlan(m_trialPlan, m_loggedPlanTrials);
+		if (!m_trialPlanFilename.empty()) {
+			m_trialPlan.save(m_trialPlanFilename, m_loggedPlanTrials);
 		}
 	}
-	if (unrunTrialIdxs.size() == 0) return;
-	int idx = Random::common().integer(0, unrunTrialIdxs.size()-1);
-	m_currTrialIdx = unrunTrialIdxs[idx];
+	m_loggedPlanTrials = m_trialPlan.size();
 }
 
 bool Session::isComplete() const{
@@ -52,9 +64,9 @@ bool Session::isComplete() const{
 	return allTrialsComplete;
 }
 
-bool Session::setupTrialParams(Array<Array<shared_ptr<TargetConfig>>> trials) {
+bool Session::setupTrialParams(const Array<Array<shared_ptr<const TargetConfig>>>& trials) {
 	for (int i = 0; i < trials.size(); i++) {
-		Array<shared_ptr<TargetConfig>> targets = trials[i];
+		const Array<shared_ptr<const TargetConfig>>& targets = trials[i];
 		for (int j = 0; j < targets.size(); j++) {
 			const String name = format("%s_%d_%s_%d", m_config->id, i, targets[j]->id, j);
 			if (m_config->logger.enable) {
@@ -64,6 +76,17 @@ bool Session::setupTrialParams(Array<Array<shared_ptr<TargetConfig>>> trials) {
 		m_remainingTrials.append(m_config->trials[i].count);
 		m_targetConfigs.append(targets);
 	}
+
+	// Compile the trial order and target spawn parameters up front
+	m_trialPlan.init(m_targetConfigs, m_remainingTrials, m_randomSeed, m_modelScaleCount);
+	if (m_trialPlan.isFinite()) {
+		m_trialPlan.compileAll();
+	}
+	else {
+		m_trialPlan.compile(m_trialPlanHorizon);
+	}
+	logTrialPlan();
+
 	nextCondition();
 	return true;
 }
@@ -72,6 +95,9 @@ void Session::onInit(String filename, String description) {
 	// Initialize presentation states
 	presentationState = PresentationState::initial;
 	m_feedbackMessage = "Click to spawn a target, then use shift on red target to begin.";
+	m_timeline.startTimer();
+	m_simTime = 0.0;
+	m_frameIndex = 0;
 
 	// Get the player from the app
 	m_player = m_app->scene()->typedEntity<PlayerEntity>("player");
@@ -83,40 +109,60 @@ void Session::onInit(String filename, String description) {
 
 	// Check for valid session
 	if (m_hasSession) {
+		// Pick (or reuse the configured) session seed before creating the logger so it is recorded
+		if (m_config->randomSeed < 0) {
+			m_config->randomSeed = int(Random::common().bits() & 0x7FFFFFFF);
+		}
+		m_randomSeed = uint32(m_config->randomSeed);
+		m_targetClock.setRate(m_config->timing.targetSimRate);
+		const int simThreads = m_config->timing.targetSimThreads;
+		m_motionWorkers.start((simThreads < 0) ? (int)std::thread::hardware_concurrency() : simThreads);
+
 		if (m_config->logger.enable) {
 			UserConfig user = *m_app->getCurrUser();
 			// Setup the logger and create results file
 			m_logger = Logger::create(filename, user.id, m_config, description);
+			m_trialPlanFilename = filename.substr(0, filename.rfind('.')) + "_plan.csv";
 			if (m_config->logger.logUsers) {
 				m_logger->logUserConfig(user, m_config->id, "start");
 			}
+			if (m_config->logger.logRawInput) {
+				m_rawInput = RawInputCapture::create();
+			}
+		}
+		if (m_config->logger.telemetryEnable) {
+			m_telemetry = TelemetryPublisher::create(m_config->logger.telemetryPort);
 		}
 		// Iterate over the sessions here and add a config for each
-		Array<Array<shared_ptr<TargetConfig>>> trials = m_app->experimentConfig.getTargetsForSession(m_config->id);
-		setupTrialParams(trials);
+		setupTrialParams(m_app->experimentConfig.getTargetsForSession(m_config->id));
+		prewarmTargetPool();
+		prefetchTrial();
 	}
 	else {	// Invalid session, move to displaying message
 		presentationState = PresentationState::scoreboard;
 	}
 }
 
-void Session::randomizePosition(const shared_ptr<TargetEntity>& target) const {
+void Session::randomizePosition(const shared_ptr<TargetEntity>& target) {
 	static const Point3 initialSpawnPos = m_camera->frame().translation;
-	shared_ptr<TargetConfig> config = m_targetConfigs[m_currTrialIdx][target->paramIdx()];
+	shared_ptr<const TargetConfig> config = m_targetConfigs[m_currTrialIdx][target->paramIdx()];
 	const bool isWorldSpace = config->destSpace == "world";
+	CounterRandom& rng = target->rng();
 	Point3 loc;
 
 	if (isWorldSpace) {
-		loc = config->spawnBounds.randomInteriorPoint();		// Set a random position in the bounds
-		target->resetMotionParams();							// Reset the target motion behavior
+		loc = rng.randomInteriorPoint(config->spawnBounds);		// Set a random position in the bounds
 	}
 	else {
-		const float rot_pitch = randSign() * Random::common().uniform(config->eccV[0], config->eccV[1]);
-		const float rot_yaw = randSign() * Random::common().uniform(config->eccH[0], config->eccH[1]);
+		const float rot_pitch = rng.sign() * rng.uniform(config->eccV[0], config->eccV[1]);
+		const float rot_yaw = rng.sign() * rng.uniform(config->eccH[0], config->eccH[1]);
 		const CFrame f = CFrame::fromXYZYPRDegrees(initialSpawnPos.x, initialSpawnPos.y, initialSpawnPos.z, rot_yaw - 180.0f/(float)pi()*initialHeadingRadians, rot_pitch, 0.0f);
 		loc = f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
 	}
 	target->setFrame(loc);
+	target->resetMotionParams();								// Reset the target motion behavior (from the new position)
+	target->resetStep();
+	m_worldMotion.resync(target);
 }
 
 void Session::initTargetAnimation() {
@@ -127,35 +173,17 @@ void Session::initTargetAnimation() {
 
 	// In task state, spawn a test target. Otherwise spawn a target at straight ahead.
 	if (presentationState == PresentationState::task) {
-		// Iterate through the targets
-		for (int i = 0; i < m_targetConfigs[m_currTrialIdx].size(); i++) {
-			
-			const String name = format("%s_%d_%s_%d", m_config->id, m_currTrialIdx, m_targetConfigs[m_currTrialIdx][i]->id, i);
-			const Color3 initColor = m_config->targetView.healthColors[0];
-			shared_ptr<TargetConfig> target = m_targetConfigs[m_currTrialIdx][i];
-
-			const float rot_pitch = randSign() * Random::common().uniform(target->eccV[0], target->eccV[1]);
-			const float rot_yaw = randSign() * Random::common().uniform(target->eccH[0], target->eccH[1]);
-			const float targetSize = G3D::Random().common().uniform(target->size[0], target->size[1]);
-			bool isWorldSpace = target->destSpace == "world";
-
-			CFrame f = CFrame::fromXYZYPRDegrees(initialSpawnPos.x, initialSpawnPos.y, initialSpawnPos.z, rot_yaw- (initialHeadingRadians * 180.0f / (float)pi()), rot_pitch, 0.0f);
-
-			// Check for case w/ destination array
-			if (target->destinations.size() > 0) {
-				Point3 offset =isWorldSpace ? Point3(0.0, 0.0, 0.0) : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
-				shared_ptr<TargetEntity> t = spawnDestTarget(target, offset, initColor, i, name);
-			}
-			// Otherwise check if this is a jumping target
-			else if (target->jumpEnabled) {
-				Point3 offset = isWorldSpace ? target->spawnBounds.randomInteriorPoint() : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
-				shared_ptr<JumpingEntity> t = spawnJumpingTarget(target, offset, initialSpawnPos, initColor, m_targetDistance, i, name);
-			}
-			else {
-				Point3 offset = isWorldSpace ? target->spawnBounds.randomInteriorPoint() : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
-				shared_ptr<FlyingEntity> t = spawnFlyingTarget(target, offset, initialSpawnPos, initColor, i, name);
-			}
+		// Targets are normally prefetched during feedback, make sure they match this trial
+		if (m_prefetchedTrialIdx != m_currTrialIdx || m_prefetchedTrialNumber != m_trialNumber) {
+			prefetchTrial();
 		}
+		for (int i = 0; i < m_prefetched.size(); i++) {
+			spawnPrefetchedTarget(m_prefetched[i], i, initialSpawnPos);
+		}
+		m_prefetched.fastClear();
+		m_prefetchedTrialIdx = -1;
+		m_trialNumber++;
+		m_trialStats.reset();
 	}
 	else {
 		// Make sure we reset the target color here (avoid color bugs)
@@ -178,7 +206,7 @@ void Session::processResponse()
 	m_taskExecutionTime = m_timer.getTime();
 	// Get total target count here
 	int totalTargets = 0;
-	for (shared_ptr<TargetConfig> target : m_targetConfigs[m_currTrialIdx]) {
+	for (shared_ptr<const TargetConfig> target : m_targetConfigs[m_currTrialIdx]) {
 		if (target->respawnCount == -1) {
 			totalTargets = -1;		// Ininite spawn case
 			break;
@@ -244,6 +272,11 @@ void Session::updatePresentationState()
 			m_taskEndTime = Logger::genUniqueTimestamp();
 			processResponse();
 			clearTargets(); // clear all remaining targets
+			// Pick the next condition now so its targets can be built during feedback
+			if (!isComplete()) {
+				nextCondition();
+				prefetchTrial();
+			}
 			newState = PresentationState::feedback;
 			if (m_config->player.stillBetweenTrials) {
 				m_player->setMoveEnable(false);
@@ -285,6 +318,8 @@ void Session::updatePresentationState()
 						m_logger->flush(false);
 						m_logger.reset();
 					}
+					m_rawInput.reset();
+					m_telemetry.reset();
 					m_app->markSessComplete(m_config->id);														// Add this session to user's completed sessions
 					m_app->updateSessionDropDown();
 
@@ -296,7 +331,6 @@ void Session::updatePresentationState()
 			}
 			else {
 				m_feedbackMessage = "";
-				nextCondition();
 				newState = PresentationState::ready;
 			}
 		}
@@ -329,6 +363,7 @@ void Session::updatePresentationState()
 
 	if (currentState != newState)
 	{ // handle state transition.
+		recordStateTransition(currentState, newState);
 		m_timer.startTimer();
 		if (newState == PresentationState::task) {
 			m_taskStartTime = Logger::genUniqueTimestamp();
@@ -343,6 +378,9 @@ void Session::updatePresentationState()
 
 void Session::onSimulation(RealTime rdt, SimTime sdt, SimTime idt)
 {
+	m_frameIndex++;
+	m_simTime += sdt;
+
 	// 1. Update presentation state and send task performance to psychophysics library.
 	updatePresentationState();
 
@@ -350,12 +388,29 @@ void Session::onSimulation(RealTime rdt, SimTime sdt, SimTime idt)
 	if (presentationState == PresentationState::task)
 	{
 		accumulateTrajectories();
-		accumulateFrameInfo(rdt, sdt, idt);
+		accumulateAimError();
+	}
+	accumulateRawInput();
+}
+
+void Session::simulateTargetMotion(SimTime absoluteTime, SimTime deltaTime)
+{
+	if (m_targetClock.enabled()) {
+		m_targetClock.advance(absoluteTime, deltaTime, m_targetArray, m_motionWorkers, m_worldMotion);
+	}
+	else {
+		if (m_motionWorkers.enabled()) {
+			m_motionWorkers.simulate(m_targetArray, absoluteTime, deltaTime);
+		}
+		m_worldMotion.simulate(absoluteTime, deltaTime);
 	}
 }
 
 void Session::recordTrialResponse(int destroyedTargets, int totalTargets)
 {
+	if (notNull(m_telemetry)) {
+		m_telemetry->publishTrial(Logger::getFileTime(), m_currTrialIdx, (float)m_taskExecutionTime, destroyedTargets, totalTargets);
+	}
 	if (!m_config->logger.enable) return;		// Skip this if the logger is disabled
 	if (m_config->logger.logTrialResponse) {
 		// Trials table. Record trial start time, end time, and task completion time.
@@ -370,14 +425,50 @@ void Session::recordTrialResponse(int destroyedTargets, int totalTargets)
 			String(std::to_string(totalTargets))
 		};
 		m_logger->logTrial(trialValues);
+
+		// Trial_Stats table, from the streaming accumulators
+		const TrialStats& s = m_trialStats;
+		const int targetsHit = s.targetHits.size();
+		Logger::TrialValues statsValues = {
+			String(std::to_string(m_trialNumber - 1)),
+			String(std::to_string(m_currTrialIdx)),
+			"'" + m_config->id + "'",
+			String(std::to_string(s.shots)),
+			String(std::to_string(s.hits)),
+			String(std::to_string(s.misses)),
+			String(std::to_string(s.kills)),
+			String(std::to_string(targetsHit)),
+			String(std::to_string((s.shots > 0) ? float(s.hitShots) / float(s.shots) : 0.0f)),
+			String(std::to_string((targetsHit > 0) ? float(s.hits) / float(targetsHit) : 0.0f)),
+			String(std::to_string(s.firstHitTime)),
+			String(std::to_string(s.firstKillTime)),
+			String(std::to_string((s.kills > 0) ? s.totalKillTime / float(s.kills) : -1.0f))
+		};
+		m_logger->logTrialStats(statsValues);
+	}
+}
+
+void Session::recordStateTransition(PresentationState from, PresentationState to)
+{
+	static const char* stateNames[] = { "initial", "ready", "task", "feedback", "scoreboard", "complete" };
+	if (notNull(m_logger) && m_config->logger.logStateTimeline) {
+		StateTransition transition;
+		transition.time = Logger::getFileTime();
+		transition.timelineNs = m_timeline.getTimeNs();
+		transition.simTime = m_simTime;
+		transition.frame = m_frameIndex;
+		transition.trialIdx = m_currTrialIdx;
+		transition.fromState = stateNames[from];
+		transition.toState = stateNames[to];
+		m_logger->logStateTransition(transition);
 	}
 }
 
 void Session::accumulateTrajectories()
 {
 	if (notNull(m_logger) && m_config->logger.logTargetTrajectories) {
-		for (shared_ptr<TargetEntity> target : m_targetArray) {
-			if (!target->isLogged()) continue;
+		for (const shared_ptr<TargetEntity>& target : m_targetArray) {
+			if (!target->isLogged() || target->isBaked()) continue;		// Baked paths are logged once (at spawn)
 			// recording target trajectories
 			Point3 targetAbsolutePosition = target->frame().translation;
 			Point3 initialSpawnPos = m_camera->frame().translation;
@@ -395,8 +486,67 @@ void Session::accumulateTrajectories()
 	accumulatePlayerAction(PlayerActionType::Aim);
 }
 
+void Session::accumulateAimError()
+{
+	if (isNull(m_logger) || !m_config->logger.logAimError) return;
+	BEGIN_PROFILER_EVENT("accumulateAimError");
+	const int count = m_targetArray.size();
+	m_aimX.resize(count, false);
+	m_aimY.resize(count, false);
+	m_aimZ.resize(count, false);
+	for (int i = 0; i < count; i++) {
+		const Point3& p = m_targetArray[i]->frame().translation;
+		m_aimX[i] = p.x;
+		m_aimY[i] = p.y;
+		m_aimZ[i] = p.z;
+	}
+	const CFrame& view = m_camera->frame();
+	AimError error = computeAimError(view.translation, view.lookVector(), m_aimX, m_aimY, m_aimZ, m_aimErrors);
+	error.time = Logger::getFileTime();
+	if (error.nearestIdx >= 0) error.nearestTarget = m_targetArray[error.nearestIdx]->name();
+	m_logger->logAimError(error);
+	END_PROFILER_EVENT();
+}
+
+void Session::accumulateRawInput()
+{
+	if (isNull(m_rawInput)) return;
+	// Always drain the capture buffer so it never fills, but only log events during the task
+	m_rawInputEvents.fastClear();
+	m_rawInput->drain(m_rawInputEvents);
+	if (notNull(m_logger) && presentationState == PresentationState::task && m_rawInputEvents.size() > 0) {
+		m_logger->logRawInput(m_rawInputEvents);
+	}
+}
+
 void Session::accumulatePlayerAction(PlayerActionType action, String targetName)
 {
+	if (presentationState == PresentationState::task) {
+		const float t = m_timer.getTime();
+		switch (action) {
+		case Miss:
+			m_trialStats.misses++;
+			break;
+		case Destroy:
+			m_trialStats.kills++;
+			m_trialStats.totalKillTime += t - m_trialStats.spawnTimes.getWithDefault(targetName, 0.0f);
+			m_trialStats.spawnTimes.set(targetName, t);		// Destroyed targets respawn (if they do) immediately
+			if (m_trialStats.firstKillTime < 0.0f) m_trialStats.firstKillTime = t;
+			// Fall through (a destroying shot is also a hit)
+		case Hit:
+			m_trialStats.hits++;
+			if (m_trialStats.lastHitShot != m_trialStats.shots) {
+				m_trialStats.hitShots++;
+				m_trialStats.lastHitShot = m_trialStats.shots;
+			}
+			m_trialStats.targetHits.getCreate(targetName)++;
+			if (m_trialStats.firstHitTime < 0.0f) m_trialStats.firstHitTime = t;
+			break;
+		default:
+			break;
+		}
+	}
+
 	if (notNull(m_logger) && m_config->logger.logPlayerActions) {
 		BEGIN_PROFILER_EVENT("accumulatePlayerAction");
 		// recording target trajectories
@@ -406,11 +556,20 @@ void Session::accumulatePlayerAction(PlayerActionType action, String targetName)
 		m_logger->logPlayerAction(pa);
 		END_PROFILER_EVENT();
 	}
+	if (notNull(m_telemetry)) {
+		m_telemetry->publishPlayerAction(PlayerAction(Logger::getFileTime(), getViewDirection(), getPlayerLocation(), action, targetName));
+	}
 }
 
-void Session::accumulateFrameInfo(RealTime t, float sdt, float idt) {
+void Session::accumulateFrameInfo(const FrameInfo& info) {
+	// Telemetry covers the whole study, only task frames are logged
+	if (notNull(m_telemetry)) {
+		const size_t queued = notNull(m_logger) ? m_logger->queuedBytes() : 0;
+		m_telemetry->publishFrame(info.time, info.rdt, info.sdt, info.idt, queued);
+	}
+	if (presentationState != PresentationState::task) return;
 	if (notNull(m_logger) && m_config->logger.logFrameInfo) {
-		m_logger->logFrameInfo(FrameInfo(Logger::getFileTime(), sdt));
+		m_logger->logFrameInfo(info);
 	}
 }
 
@@ -467,6 +626,8 @@ void Session::endLogging() {
 	if (m_logger != nullptr) {
 		m_logger.reset();
 	}
+	m_rawInput.reset();
+	m_telemetry.reset();
 }
 
 // Comment these since they are unused
@@ -590,31 +751,6 @@ void Session::endLogging() {
 //	return target;
 //}
 
-shared_ptr<TargetEntity> Session::spawnDestTarget(
-	shared_ptr<TargetConfig> config,
-	const Point3& position,
-	const Color3& color,
-	const int paramIdx,
-	const String& name)
-{
-	// Create the target
-	const float targetSize = G3D::Random().common().uniform(config->size[0], config->size[1]);
-	const String nameStr = name.empty() ? format("target%03d", ++m_lastUniqueID) : name;
-	const int scaleIndex = clamp(iRound(log(targetSize) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
-
-	const shared_ptr<TargetEntity>& target = TargetEntity::create(config, nameStr, m_scene, (*m_targetModels)[config->id][scaleIndex], position, scaleIndex, paramIdx);
-
-	// Update parameters for the target
-	target->setHitSound(config->hitSound, config->hitSoundVol);
-	target->setDestoyedSound(config->destroyedSound, config->destroyedSoundVol);
-	target->setFrame(position);
-	target->setColor(color);
-
-	// Add target to array and scene
-	insertTarget(target);
-	return target;
-}
-
 shared_ptr<FlyingEntity> Session::spawnReferenceTarget(
 	const Point3& position,
 	const Point3& orbitCenter,
@@ -622,103 +758,196 @@ shared_ptr<FlyingEntity> Session::spawnReferenceTarget(
 	const Color3& color)
 {
 	const int scaleIndex = clamp(iRound(log(size) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
-	const shared_ptr<FlyingEntity>& target = FlyingEntity::create("reference", m_scene, (*m_targetModels)["reference"][scaleIndex], CFrame());
+	const shared_ptr<FlyingEntity>& target = FlyingEntity::create("reference", m_scene, m_targetModels->model("reference", scaleIndex), CFrame());
 
 	// Setup additional target parameters
 	target->setFrame(position);
-	target->setColor(color);
+	target->setPalettePose(m_app->targetPalette.pose(color));
 
 	// Add target to array and scene
 	insertTarget(target);
 	return target;
 }
 
-shared_ptr<FlyingEntity> Session::spawnFlyingTarget(
-	shared_ptr<TargetConfig> config,
-	const Point3& position,
-	const Point3& orbitCenter,
-	const Color3& color,
-	const int paramIdx,
-	const String& name)
-{
-	const float targetSize = G3D::Random().common().uniform(config->size[0], config->size[1]);
-	const int scaleIndex = clamp(iRound(log(targetSize) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
-	const String nameStr = name.empty() ? format("target%03d", ++m_lastUniqueID) : name;
-	const bool isWorldSpace = config->destSpace == "world";
+void Session::prefetchTrial() {
+	releasePrefetchedTargets();
+	if (!m_trialPlan.contains(m_trialNumber)) return;
+	const PlannedTrial& planned = m_trialPlan[m_trialNumber];
+	debugAssertM(planned.trialIdx == m_currTrialIdx, "Prefetching a trial that doesn't match the trial plan!");
+	const shared_ptr<ArticulatedModel::Pose>& spawnPose = m_app->targetPalette.pose(m_app->targetPalette.spawnIndex());
+	for (int i = 0; i < planned.targets.size(); i++) {
+		const shared_ptr<const TargetConfig>& config = m_targetConfigs[planned.trialIdx][i];
+		const PlannedTarget& t = planned.targets[i];
+		const bool isWorldSpace = config->destSpace == "world";
+		PrefetchedTarget p;
+		p.name = format("%s_%d_%s_%d", m_config->id, planned.trialIdx, config->id, i);
+
+		// Spawn parameters come from the plan, the target's stream resumes where the plan's draws left off
+		p.rng = CounterRandom(m_randomSeed, CounterRandom::targetStream(m_trialNumber, i));
+		p.rng.setCounter(t.rngCounter);
+		p.pitch = t.pitch;
+		p.yaw = t.yaw;
+		p.spawnPos = t.spawnPos;
+		const int scaleIndex = t.scaleIdx;
+		const shared_ptr<Model>& model = m_targetModels->model(config->id, scaleIndex);
+
+		// Baked targets are pre-simulated in the background (relative to the player for player space targets) while this trial is pending
+		if (config->isBaked()) {
+			const CFrame f = CFrame::fromXYZYPRDegrees(0.0f, 0.0f, 0.0f, p.yaw - (initialHeadingRadians * 180.0f / (float)pi()), p.pitch, 0.0f);
+			const Point3 start = isWorldSpace ? p.spawnPos : f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
+			const SimTime duration = min(config->bakeDuration, m_config->timing.taskDuration);
+			p.bakedPath = std::async(std::launch::async, &TrajectoryBaker::bake, config, start, Point3::zero(), m_targetDistance, i, p.rng, duration, 0.001f).share();
+		}
 
-	// Setup the target
-	const shared_ptr<FlyingEntity>& target = FlyingEntity::create(config, nameStr, m_scene, (*m_targetModels)[config->id][scaleIndex], orbitCenter, scaleIndex, paramIdx);
-	target->setFrame(position);
-	target->setWorldSpace(isWorldSpace);
-	if (isWorldSpace) {
-		target->setBounds(config->moveBounds);
+		// Build (or reuse) the entity now, it is reinitialized (cheaply) w/ its final position when the task starts
+		p.entity = m_targetPool.acquire<TargetEntity>(config->id, scaleIndex);
+		if (isNull(p.entity)) {
+			p.entity = TargetEntity::createFromConfig(config, p.name, m_scene, model, scaleIndex, i, m_targetDistance, p.rng);
+		}
+		p.entity->setHitSound(config->hitSound, config->hitSoundVol);
+		p.entity->setDestoyedSound(config->destroyedSound, config->destroyedSoundVol);
+		p.entity->setPalettePose(spawnPose);
+		m_prefetched.append(p);
 	}
-	target->setHitSound(config->hitSound, config->hitSoundVol);
-	target->setDestoyedSound(config->destroyedSound, config->destroyedSoundVol);
-	target->setColor(color);
+	m_prefetchedTrialIdx = m_currTrialIdx;
+	m_prefetchedTrialNumber = m_trialNumber;
+}
 
-	// Add the target to the scene/target array
-	insertTarget(target);
-	return target;
+void Session::releasePrefetchedTargets() {
+	for (const PrefetchedTarget& p : m_prefetched) {
+		m_targetPool.release(p.entity);
+	}
+	m_prefetched.fastClear();
+	m_prefetchedTrialIdx = -1;
+	m_prefetchedTrialNumber = -1;
 }
 
-shared_ptr<JumpingEntity> Session::spawnJumpingTarget(
-	shared_ptr<TargetConfig> config,
-	const Point3& position,
-	const Point3& orbitCenter,
-	const Color3& color,
-	const float targetDistance,
-	const int paramIdx,
-	const String& name)
-{
-	const float targetSize = G3D::Random().common().uniform(config->size[0], config->size[1]);
-	const int scaleIndex = clamp(iRound(log(targetSize) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
-	const String nameStr = name.empty() ? format("target%03d", ++m_lastUniqueID) : name;
+void Session::spawnPrefetchedTarget(const PrefetchedTarget& p, int paramIdx, const Point3& initialSpawnPos) {
+	const shared_ptr<const TargetConfig>& config = m_targetConfigs[m_currTrialIdx][paramIdx];
 	const bool isWorldSpace = config->destSpace == "world";
+	const CFrame f = CFrame::fromXYZYPRDegrees(initialSpawnPos.x, initialSpawnPos.y, initialSpawnPos.z, p.yaw - (initialHeadingRadians * 180.0f / (float)pi()), p.pitch, 0.0f);
+	const Point3 playerSpacePos = f.pointToWorldSpace(Point3(0, 0, -m_targetDistance));
 
-	// Setup the target
-	const shared_ptr<JumpingEntity>& target = JumpingEntity::create(config, nameStr, m_scene, (*m_targetModels)[config->id][scaleIndex], scaleIndex, orbitCenter, targetDistance, paramIdx);
-	target->setFrame(position);
-	target->setWorldSpace(isWorldSpace);
-	if (isWorldSpace) {
-		target->setMoveBounds(config->moveBounds);
+	// Wait for a baked path (normally finished during the feedback state), then play it back
+	const Array<Destination> noPath;
+	const Array<Destination>& path = config->isBaked() ? p.bakedPath.get() : noPath;
+	TargetEntity::spawnFromConfig(p.entity, config, p.name, paramIdx, p.rng, initialSpawnPos, m_targetDistance, playerSpacePos, p.spawnPos, path);
+	if (config->isBaked() && notNull(m_logger) && m_config->logger.logTargetTrajectories && config->logTargetTrajectory) {
+		const Point3 offset = isWorldSpace ? Point3::zero() : initialSpawnPos;
+		m_logger->logBakedTrajectory(p.name, Logger::getFileTime(), path, offset - initialSpawnPos);
+	}
+	insertTarget(p.entity);
+	if (config->isBatchedWorldMotion()) {
+		m_worldMotion.add(std::static_pointer_cast<FlyingEntity>(p.entity));
 	}
-	target->setHitSound(config->hitSound, config->hitSoundVol);
-	target->setDestoyedSound(config->destroyedSound, config->destroyedSoundVol);
-	target->setColor(color);
-
-	// Add the target to the scene/target array
-	insertTarget(target);
-	return target;
 }
 
-void Session::insertTarget(shared_ptr<TargetEntity> target) {
+TargetHandle Session::insertTarget(shared_ptr<TargetEntity> target) {
 	target->setShouldBeSaved(false);
+
+	// Reuse a free slot if there is one
+	int slotIdx;
+	if (m_freeTargetSlots.size() > 0) {
+		slotIdx = m_freeTargetSlots.pop();
+	}
+	else {
+		slotIdx = m_targetSlots.size();
+		m_targetSlots.next();
+	}
+	TargetSlot& slot = m_targetSlots[slotIdx];
+	slot.target = target;
+	slot.denseIdx = m_targetArray.size();
+
+	const TargetHandle handle(slotIdx, slot.generation);
+	target->setHandle(handle);
+	target->setExternalMotion(m_targetClock.enabled() || m_motionWorkers.enabled());
 	m_targetArray.append(target);
+	m_targetSlotIdx.append(slotIdx);
 	m_scene->insert(target);
+	return handle;
+}
+
+shared_ptr<TargetEntity> Session::target(TargetHandle handle) const {
+	if (handle.index < 0 || handle.index >= m_targetSlots.size()) return nullptr;
+	const TargetSlot& slot = m_targetSlots[handle.index];
+	return (slot.generation == handle.generation) ? slot.target : nullptr;
 }
 
 void Session::destroyTarget(int index) {
-	// Not a reference because we're about to manipulate the array
-	const shared_ptr<VisibleEntity> target = m_targetArray[index];
-	// Remove the target from the target array
-	m_targetArray.fastRemove(index);
-	// Remove the target from the scene
-	m_scene->removeEntity(target->name());
-}
-
-void Session::destroyTarget(shared_ptr<TargetEntity> target) {
-	for (int i = 0; i < m_targetArray.size(); i++) {
-		if (m_targetArray[i]->name() == target->name()) {
-			m_targetArray.fastRemove(i);
+	destroyTarget(m_targetArray[index]->handle());
+}
+
+void Session::destroyTarget(const shared_ptr<TargetEntity>& target) {
+	destroyTarget(target->handle());
+}
+
+void Session::destroyTarget(TargetHandle handle) {
+	if (isNull(target(handle))) return;			// Stale handle (already destroyed)
+	TargetSlot& slot = m_targetSlots[handle.index];
+	const shared_ptr<TargetEntity> entity = slot.target;
+
+	// Swap the last live target into this target's place in the dense array
+	const int denseIdx = slot.denseIdx;
+	m_targetArray.fastRemove(denseIdx);
+	m_targetSlotIdx.fastRemove(denseIdx);
+	if (denseIdx < m_targetArray.size()) {
+		m_targetSlots[m_targetSlotIdx[denseIdx]].denseIdx = denseIdx;
+	}
+
+	// Free the slot (bumping the generation invalidates outstanding handles)
+	slot.target.reset();
+	slot.denseIdx = -1;
+	slot.generation++;
+	m_freeTargetSlots.append(handle.index);
+
+	entity->setHandle(TargetHandle());
+	m_worldMotion.remove(entity);
+	m_scene->remove(entity);
+
+	// Keep task targets around for reuse in later trials
+	m_targetPool.release(entity);
+}
+
+void Session::prewarmTargetPool() {
+	// Find the most targets of each config used at once (in any trial)
+	Table<String, int> counts;
+	Table<String, shared_ptr<const TargetConfig>> configs;
+	for (const Array<shared_ptr<const TargetConfig>>& trial : m_targetConfigs) {
+		Table<String, int> trialCounts;
+		for (const shared_ptr<const TargetConfig>& config : trial) {
+			trialCounts.getCreate(config->id)++;
+			configs.set(config->id, config);
+		}
+		for (const Table<String, int>::Entry& e : trialCounts) {
+			counts.set(e.key, max(counts.getWithDefault(e.key, 0), e.value));
+		}
+	}
+
+	// Create that many targets at every scale index the config's size range can produce
+	for (const Table<String, shared_ptr<const TargetConfig>>::Entry& e : configs) {
+		const shared_ptr<const TargetConfig>& config = e.value;
+		const int count = counts[config->id];
+		const int minScale = clamp(iRound(log(config->size[0]) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
+		const int maxScale = clamp(iRound(log(config->size[1]) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
+		for (int scaleIdx = minScale; scaleIdx <= maxScale; scaleIdx++) {
+			const shared_ptr<Model>& model = m_targetModels->model(config->id, scaleIdx);
+			m_targetModels->explosion(config->id, scaleIdx);		// Load the explosion now (rather than on the first destroy)
+			for (int i = m_targetPool.available(config->id, scaleIdx); i < count; i++) {
+				const shared_ptr<TargetEntity> target = TargetEntity::createFromConfig(config, config->id, m_scene, model, scaleIdx, i, m_targetDistance, CounterRandom());
+				target->setHitSound(config->hitSound, config->hitSoundVol);
+				target->setDestoyedSound(config->destroyedSound, config->destroyedSoundVol);
+				m_targetPool.release(target);
+			}
+			debugAssertM(m_targetPool.available(config->id, scaleIdx) >= count, "Prewarmed targets were not kept by the target pool!");
 		}
 	}
-	m_scene->removeEntity(target->name());
+	logPrintf("Prewarmed session %s: %d of %d scaled target/explosion models loaded\n", m_config->id.c_str(),
+		m_targetModels->loadedCount(), 2 * m_targetModels->idCount() * m_targetModels->scaleCount());
 }
 
-/** Clear all targets one by one */
+/** Clear all targets (from the back so no targets need to be moved) */
 void Session::clearTargets() {
 	while (m_targetArray.size() > 0) {
-		destroyTarget(0);
+		destroyTarget(m_targetArray.size() - 1);
 	}
 }
\ No newline at end of file
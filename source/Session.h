@@ -29,12 +29,20 @@
 
 #include <G3D/G3D.h>
 #include "ConfigFiles.h"
+#include "CounterRandom.h"
+#include "TargetPool.h"
+#include "TargetModelTable.h"
+#include "TargetMotion.h"
+#include "TrialPlan.h"
+#include "RawInputCapture.h"
 #include <ctime>
+#include <future>
 
 class App;
 class PlayerEntity;
 class TargetEntity;
 class Logger;
+class TelemetryPublisher;
 
 // Simple timer for measuring time offsets
 class Timer
@@ -45,21 +53,74 @@ public:
 	float getTime()
 	{
 		auto now = std::chrono::steady_clock::now();
-		int t = std::chrono::duration_cast<std::chrono::duration<int, std::milli>>(now - startTime).count();
-		return ((float)t) / 1000.0f;
+		return std::chrono::duration<float>(now - startTime).count();
+	};
+	int64 getTimeNs()
+	{
+		auto now = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(now - startTime).count();
 	};
 };
 
  struct FrameInfo {
 	FILETIME time;
-	//float idt = 0.0f;
-	float sdt = 0.0f;
+	float rdt = 0.0f;						///< Real delta time (s)
+	float sdt = 0.0f;						///< Simulation delta time (s)
+	float idt = 0.0f;						///< Ideal delta time (s)
+
+	// Per-stage durations from App::oneFrame (s)
+	float userInputDuration = 0.0f;			///< User input stage duration
+	float simulationDuration = 0.0f;		///< Simulation stage duration
+	float poseDuration = 0.0f;				///< Pose stage duration
+	float waitDuration = 0.0f;				///< Wait stage duration
+	float graphicsDuration = 0.0f;			///< Graphics stage duration
+	float overWait = 0.0f;					///< Current estimate of the wait overshoot
 
 	FrameInfo() {};
 
-	FrameInfo(FILETIME t, float simDeltaTime) {
+	FrameInfo(FILETIME t, float realDeltaTime, float simDeltaTime, float idealDeltaTime) {
 		time = t;
+		rdt = realDeltaTime;
 		sdt = simDeltaTime;
+		idt = idealDeltaTime;
+	}
+};
+
+struct StateTransition {
+	FILETIME time;							///< Wall clock time of the transition
+	int64 timelineNs = 0;					///< Monotonic time since session start (ns)
+	double simTime = 0.0;					///< Accumulated simulation time since session start (s)
+	uint64 frame = 0;						///< Simulation frame index since session start
+	int trialIdx = -1;						///< Current trial index
+	String fromState = "";					///< Presentation state being left
+	String toState = "";					///< Presentation state being entered
+
+	StateTransition() {};
+};
+
+/** Per-trial statistics, accumulated as player actions happen (reset at the start of each task state) */
+struct TrialStats {
+	int shots = 0;							///< Shots fired
+	int hitShots = 0;						///< Shots that hit at least one target (a laser hits every frame it is on a target)
+	int lastHitShot = 0;					///< Shot number of the latest counted hit shot
+	int hits = 0;							///< Hits on a target (including destroying hits)
+	int misses = 0;							///< Shots that missed
+	int kills = 0;							///< Targets destroyed (including respawns)
+	float firstHitTime = -1.0f;				///< Time from task start to the first hit (s, -1 if none)
+	float firstKillTime = -1.0f;			///< Time from task start to the first kill (s, -1 if none)
+	float totalKillTime = 0.0f;				///< Sum of the times from each target's (re)spawn to its kill (s)
+	Table<String, int> targetHits;			///< Hits by target name
+	Table<String, float> spawnTimes;		///< Latest respawn time by target name (s from task start, targets spawn at task start)
+
+	TrialStats() {};
+
+	void reset() {
+		shots = hitShots = lastHitShot = 0;
+		hits = misses = kills = 0;
+		firstHitTime = firstKillTime = -1.0f;
+		totalKillTime = 0.0f;
+		targetHits.clear();
+		spawnTimes.clear();
 	}
 };
 
@@ -112,6 +173,9 @@ protected:
 	
 	shared_ptr<SessionConfig> m_config;					///< The session this experiment will run
 	shared_ptr<Logger> m_logger;						///< Output results logger
+	shared_ptr<TelemetryPublisher> m_telemetry;			///< Live telemetry publisher (null when disabled)
+	shared_ptr<RawInputCapture> m_rawInput;				///< Raw mouse input capture (null when disabled)
+	Array<RawInputEvent> m_rawInputEvents;				///< Raw input events drained this step (reused between steps)
 	shared_ptr<PlayerEntity> m_player;					///< Player entity
 	shared_ptr<Camera> m_camera;						///< Camera entity
 
@@ -119,19 +183,60 @@ protected:
 	int m_remainingTargets;								///< Number of remaining targets (calculated at the end of the session)
 	int m_destroyedTargets = 0;							///< Number of destroyed target
 	int m_clickCount = 0;								///< Count of total clicks in this trial
+	TrialStats m_trialStats;							///< Streaming statistics for the current trial
 	bool m_hasSession;									///< Flag indicating whether psych helper has loaded a valid session
 	String m_feedbackMessage;							///< Message to show when trial complete
 
 	// Target management
-	Table<String, Array<shared_ptr<ArticulatedModel>>>* m_targetModels;
+	TargetModelTable* m_targetModels;
 	int m_modelScaleCount;
 	int m_lastUniqueID = 0;								///< Counter for creating unique names for various entities
-	Array<shared_ptr<TargetEntity>> m_targetArray;		///< Array of drawn targets
+
+	/** Slot in the target registry (indexed by TargetHandle::index) */
+	struct TargetSlot {
+		shared_ptr<TargetEntity>	target;						///< Target in this slot (null if free)
+		uint32						generation = 0;				///< Incremented each time the slot is freed
+		int							denseIdx = -1;				///< Index of the target in m_targetArray
+	};
+	Array<TargetSlot> m_targetSlots;					///< Target registry slots
+	Array<int> m_freeTargetSlots;						///< Free slot indices (for O(1) insert)
+	Array<shared_ptr<TargetEntity>> m_targetArray;		///< Array of drawn targets (dense, in no particular order)
+	Array<int> m_targetSlotIdx;							///< Slot index for each entry in m_targetArray
+	TargetPool m_targetPool;							///< Destroyed targets kept for reuse
+	WorldMotionBatch m_worldMotion;						///< Batched motion for world-space flying targets
+	TargetClock m_targetClock;							///< Fixed-rate target motion clock (if enabled)
+	TargetWorkerPool m_motionWorkers;					///< Worker threads for target motion (if enabled)
+
+	// Aim error (per frame scratch, kept to avoid reallocation)
+	Array<float> m_aimX, m_aimY, m_aimZ;				///< Live target positions (SoA, gathered each frame)
+	Array<float> m_aimErrors;							///< Angular error to each live target (deg)
+
+	/** Spawn parameters and (not yet inserted) entity for a target in the upcoming trial */
+	struct PrefetchedTarget {
+		shared_ptr<TargetEntity>	entity;						///< Pre-built target
+		String						name;						///< Target name
+		CounterRandom				rng;						///< Target random stream (after the spawn parameter draws)
+		float						pitch = 0.0f;				///< Spawn pitch (deg, player space)
+		float						yaw = 0.0f;					///< Spawn yaw (deg, player space)
+		Point3						spawnPos;					///< Spawn position (world space targets only)
+		std::shared_future<Array<Destination>> bakedPath;		///< Baked trajectory (being computed in the background, if the target is baked)
+	};
+	Array<PrefetchedTarget> m_prefetched;				///< Targets built ahead of the next task state
+	int m_prefetchedTrialIdx = -1;						///< Trial index m_prefetched was built for
+	int m_prefetchedTrialNumber = -1;					///< Trial number m_prefetched was built for
 
 	int m_currTrialIdx;									///< Current trial
 	int m_currQuestionIdx = -1;							///< Current question index
 	Array<int> m_remainingTrials;								///< Completed flags
-	Array<Array<shared_ptr<TargetConfig>>> m_targetConfigs;		///< Target configurations by trial
+	Array<Array<shared_ptr<const TargetConfig>>> m_targetConfigs;		///< Target configurations by trial
+
+	// Randomization
+	uint32 m_randomSeed = 0;							///< Session seed (logged), all session/target random streams derive from this
+	TrialPlan m_trialPlan;								///< Trial order and target spawn parameters (compiled at session start)
+	const int m_trialPlanHorizon = 100;					///< Number of trials to plan ahead (for sessions w/ infinite trials)
+	int m_loggedPlanTrials = 0;							///< Number of planned trials written to the log
+	String m_trialPlanFilename;							///< CSV file the trial plan is written to (alongside the results file)
+	int m_trialNumber = 0;								///< Number of trials started in this session (selects target streams)
 
 	// Time-based parameters
 	RealTime m_taskExecutionTime;						///< Task completion time for the most recent trial
@@ -140,7 +245,10 @@ protected:
 	RealTime m_totalRemainingTime = 0;					///< Time remaining in the trial
 	RealTime m_scoreboardDuration = 10.0;				///< Show the score for at least this amount of seconds.
 	RealTime m_lastFireAt = 0.f;						///< Time of the last shot
-	Timer m_timer;										///< Timer used for timing tasks	
+	Timer m_timer;										///< Timer used for timing tasks
+	Timer m_timeline;									///< Monotonic session timeline (started in onInit)
+	double m_simTime = 0.0;								///< Accumulated simulation time since session start
+	uint64 m_frameIndex = 0;							///< Simulation frames since session start	
 	// Could move timer above to stopwatch in future
 	//Stopwatch stopwatch;			
 
@@ -174,15 +282,11 @@ protected:
 
 	//shared_ptr<FlyingEntity> spawnTarget(const Point3& position, float scale, bool spinLeft = true, const Color3& color = Color3::red(), String modelName = "model/target/target.obj");
 
-		/** Insert a target into the target array/scene */
-	inline void insertTarget(shared_ptr<TargetEntity> target);
+	/** Pre-allocate enough pooled targets that trial starts don't create any */
+	void prewarmTargetPool();
 
-	shared_ptr<TargetEntity> spawnDestTarget(
-		shared_ptr<TargetConfig> config,
-		const Point3& position,
-		const Color3& color,
-		const int paramIdx,
-		const String& name = "");
+	/** Insert a target into the target registry/scene */
+	TargetHandle insertTarget(shared_ptr<TargetEntity> target);
 
 	shared_ptr<FlyingEntity> spawnReferenceTarget(
 		const Point3& position,
@@ -191,24 +295,15 @@ protected:
 		const Color3& color
 	);
 
-	shared_ptr<FlyingEntity> spawnFlyingTarget(
-		shared_ptr<TargetConfig> config,
-		const Point3& position,
-		const Point3& orbitCenter,
-		const Color3& color,
-		const int paramIdx,
-		const String& name = ""
-	);
+	/** Write any newly planned trials to the results database/plan file */
+	void logTrialPlan();
 
-	shared_ptr<JumpingEntity> spawnJumpingTarget(
-		shared_ptr<TargetConfig> config,
-		const Point3& position,
-		const Point3& orbitCenter,
-		const Color3& color,
-		const float targetDistance,
-		const int paramIdx,
-		const String& name = ""
-	);
+	/** Build (hidden) target entities for the current trial from the trial plan */
+	void prefetchTrial();
+	/** Return any unused prefetched targets to the pool */
+	void releasePrefetchedTargets();
+	/** Position a prefetched target (relative to the player) and add it to the scene */
+	void spawnPrefetchedTarget(const PrefetchedTarget& p, int paramIdx, const Point3& initialSpawnPos);
 
 	inline Point2 getViewDirection()
 	{   // returns (azimuth, elevation), where azimuth is 0 deg when straightahead and + for right, - for left.
@@ -234,7 +329,7 @@ public:
 		return createShared<Session>(app, config);
 	}
 
-	void randomizePosition(const shared_ptr<TargetEntity>& target) const;
+	void randomizePosition(const shared_ptr<TargetEntity>& target);
 	void initTargetAnimation();
 	float weaponCooldownPercent() const;
 	RealTime lastFireTime() const {
@@ -257,20 +352,32 @@ public:
 	}
 	
 	void updatePresentationState();
+	/** Log a presentation state transition to the state timeline */
+	void recordStateTransition(enum PresentationState from, enum PresentationState to);
 	void onInit(String filename, String description);
 	void onSimulation(RealTime rdt, SimTime sdt, SimTime idt);
+	/** Advance batched target motion (call after each scene simulation step, w/ the scene's time) */
+	void simulateTargetMotion(SimTime absoluteTime, SimTime deltaTime);
 	void processResponse();
 	void recordTrialResponse(int destroyedTargets, int totalTargets);
 	void accumulateTrajectories();
-	void accumulateFrameInfo(RealTime rdt, float sdt, float idt);
+	/** Compute (and log) the angular error from the view direction to all live targets */
+	void accumulateAimError();
+	void accumulateRawInput();
+	/** Record per-frame timing (only logged in the task state) */
+	void accumulateFrameInfo(const FrameInfo& info);
 
 	void countDestroy() {
 		m_destroyedTargets += 1;
 	}
 
-	/** Destroy a target from the targets array */
+	/** Destroy a target (by index into targetArray(), by handle, or by pointer) */
 	void destroyTarget(int index);
-	void destroyTarget(shared_ptr<TargetEntity> target);
+	void destroyTarget(TargetHandle handle);
+	void destroyTarget(const shared_ptr<TargetEntity>& target);
+
+	/** Look up a target by handle, returns null if the target has been destroyed */
+	shared_ptr<TargetEntity> target(TargetHandle handle) const;
 
 	/** clear all targets (used when clearing remaining targets at the end of a trial) */
 	void clearTargets();
@@ -285,15 +392,20 @@ public:
 	void accumulatePlayerAction(PlayerActionType action, String target="");
 	bool canFire();
 
-	bool setupTrialParams(Array<Array<shared_ptr<TargetConfig>>> trials);
+	bool setupTrialParams(const Array<Array<shared_ptr<const TargetConfig>>>& trials);
 
 	bool moveOn = false;								///< Flag indicating session is complete
 	enum PresentationState presentationState;			///< Current presentation state
 
 	/** result recording */
-	void countClick() { m_clickCount++; }
+	void countClick() { m_clickCount++; m_trialStats.shots++; }
 
-	Array<shared_ptr<TargetEntity>> targetArray() {
+	/** Read-only view of the live targets (valid until the next target is inserted or destroyed) */
+	const Array<shared_ptr<TargetEntity>>& targetArray() const {
 		return m_targetArray;
 	}
+
+	int targetCount() const {
+		return m_targetArray.size();
+	}
 };
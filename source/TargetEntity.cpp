@@ -1,28 +1,19 @@
 #include "TargetEntity.h"
 #include "ConfigFiles.h"
+#include <algorithm>
 
 // Find an arbitrary vector perpendicular to and in equal length as inputV.
-// The sampling distribution is uniform along the circular line, the set of possible candidates of a perpendicular vector.,
-Point3 findPerpendicularVector(Point3 inputV) { // Note that the output vector has equal length as the input vector.
-	Point3 perpen;
-	while (true) {
-		Point3 r = Point3::random();
-		if (r.dot(inputV) > 0.1) { // avoid r being sharply aligned with the position vector
-			// calculate a perpendicular vector
-			perpen = r.cross(inputV.direction()) * inputV.length();
-			break;
-		}
-	}
-	return perpen;
-}
-
-// rotate the inputV toward destinationV by angle ang_deg.
-Point3 rotateToward(Point3 inputV, Point3 destinationV, float ang_deg) {
-	const float projection = inputV.direction().dot(destinationV.direction());
-	Point3 U = inputV.direction();
-	Point3 V = (destinationV.direction() - inputV * projection).direction();
-
-	return (cos(ang_deg * pif() / 180.0f) * U + sin(ang_deg * pif() / 180.0f) * V) * inputV.length();
+// The sampling distribution is uniform along the circular line, the set of possible candidates of a perpendicular vector.
+Point3 findPerpendicularVector(Point3 inputV, CounterRandom& rng) { // Note that the output vector has equal length as the input vector.
+	// Orthonormal basis (b1, b2) about the input direction (Duff et al. 2017), then a uniformly distributed angle in that plane
+	const Vector3 n = inputV.direction();
+	const float s = (n.z >= 0.0f) ? 1.0f : -1.0f;
+	const float a = -1.0f / (s + n.z);
+	const float b = n.x * n.y * a;
+	const Vector3 b1(1.0f + s * n.x * n.x * a, s * b, -s * n.x);
+	const Vector3 b2(b, s + n.y * n.y * a, -n.y);
+	const float phi = rng.uniform(0.0f, 2.0f * pif());
+	return (cos(phi) * b1 + sin(phi) * b2) * inputV.length();
 }
 
 shared_ptr<TargetEntity> TargetEntity::create(	
@@ -42,22 +33,115 @@ shared_ptr<TargetEntity> TargetEntity::create(
 }
 
 shared_ptr<TargetEntity> TargetEntity::create(
-	shared_ptr<TargetConfig>		config,
+	shared_ptr<const TargetConfig>		config,
 	const String&					name,
 	Scene*							scene,
 	const shared_ptr<Model>&		model,
 	const Point3&					offset,
 	int								scaleIdx,
-	int								paramIdx) 
+	int								paramIdx,
+	const CounterRandom&			rng) 
 {
 	const shared_ptr<TargetEntity>& target = createShared<TargetEntity>();
 	target->Entity::init(name, scene, CFrame(config->destinations[0].position), shared_ptr<Entity::Track>(), true, true);
 	target->VisibleEntity::init(model, true, Surface::ExpressiveLightScatteringProperties(), ArticulatedModel::PoseSpline());
-	target->TargetEntity::init(config->destinations, paramIdx, offset, config->respawnCount, scaleIdx, config->logTargetTrajectory);
-	target->m_id = config->id;
+	target->m_scaleIdx = scaleIdx;
+	target->reinit(config, name, offset, paramIdx, rng);
 	return target;
 }
 
+void TargetEntity::resetSpawnState(const String& name, const String& id, const CounterRandom& rng) {
+	m_name = name;
+	m_id = id;
+	m_rng = rng;
+	m_health = 1.0f;
+	m_spawnTime = 0;
+	m_nextChangeTime = 0;
+	m_velocity = Vector3::zero();
+	m_handle = TargetHandle();
+}
+
+void TargetEntity::reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& offset, int paramIdx, const CounterRandom& rng) {
+	reinit(config, name, offset, paramIdx, rng, config->destinations);
+}
+
+void TargetEntity::reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& offset, int paramIdx, const CounterRandom& rng, const Array<Destination>& path) {
+	resetSpawnState(name, config->id, rng);
+	m_baked = config->isBaked();
+	m_splinePath = !m_baked && config->pathInterpolation == "catmullrom";		// Baked paths are decimated for linear playback
+	TargetEntity::init(path, paramIdx, offset, config->respawnCount, m_scaleIdx, config->logTargetTrajectory);
+}
+
+shared_ptr<TargetEntity> TargetEntity::createFromConfig(
+	shared_ptr<const TargetConfig>	config,
+	const String&					name,
+	Scene*							scene,
+	const shared_ptr<Model>&		model,
+	int								scaleIdx,
+	int								paramIdx,
+	float							targetDistance,
+	const CounterRandom&			rng)
+{
+	const bool isWorldSpace = config->destSpace == "world";
+	if (config->isBaked()) {
+		// Placeholder path (the baked path replaces it at spawn), reinit sets the config ID so the target can be pooled
+		const shared_ptr<TargetEntity> target = TargetEntity::create(Array<Destination>({ Destination() }), name, scene, model, scaleIdx, paramIdx);
+		target->reinit(config, name, Point3::zero(), paramIdx, rng, Array<Destination>({ Destination() }));
+		return target;
+	}
+	else if (config->destinations.size() > 0) {
+		return TargetEntity::create(config, name, scene, model, Point3::zero(), scaleIdx, paramIdx, rng);
+	}
+	else if (config->jumpEnabled) {
+		const shared_ptr<JumpingEntity> target = JumpingEntity::create(config, name, scene, model, scaleIdx, Point3::zero(), targetDistance, paramIdx, rng);
+		target->setWorldSpace(isWorldSpace);
+		if (isWorldSpace) target->setMoveBounds(config->moveBounds);
+		return target;
+	}
+	else {
+		const shared_ptr<FlyingEntity> target = FlyingEntity::create(config, name, scene, model, Point3::zero(), scaleIdx, paramIdx, rng);
+		target->setWorldSpace(isWorldSpace);
+		if (isWorldSpace) target->setBounds(config->moveBounds);
+		return target;
+	}
+}
+
+Point3 TargetEntity::spawnFromConfig(
+	const shared_ptr<TargetEntity>&	target,
+	shared_ptr<const TargetConfig>	config,
+	const String&					name,
+	int								paramIdx,
+	const CounterRandom&			rng,
+	const Point3&					orbitCenter,
+	float							targetDistance,
+	const Point3&					playerSpacePos,
+	const Point3&					worldSpawnPos,
+	const Array<Destination>&		bakedPath)
+{
+	// Only the position-dependent state is set here (no allocation)
+	const bool isWorldSpace = config->destSpace == "world";
+	Point3 position;
+	if (config->isBaked()) {
+		const Point3 offset = isWorldSpace ? Point3::zero() : orbitCenter;
+		target->reinit(config, name, offset, paramIdx, rng, bakedPath);
+		position = bakedPath[0].position + offset;
+	}
+	else if (config->destinations.size() > 0) {
+		position = isWorldSpace ? Point3::zero() : playerSpacePos;
+		target->reinit(config, name, position, paramIdx, rng);
+	}
+	else if (config->jumpEnabled) {
+		position = isWorldSpace ? worldSpawnPos : playerSpacePos;
+		static_cast<JumpingEntity*>(target.get())->reinit(config, name, orbitCenter, targetDistance, paramIdx, rng);
+	}
+	else {
+		position = isWorldSpace ? worldSpawnPos : playerSpacePos;
+		static_cast<FlyingEntity*>(target.get())->reinit(config, name, orbitCenter, paramIdx, rng);
+	}
+	target->setFrame(position);
+	return position;
+}
+
 void TargetEntity::drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, Point2 size, Point3 offset, Point2 border, Array<Color4> colors, Color4 borderColor) const
 {
 	// Abort if the target is not in front of the camera 
@@ -90,46 +174,120 @@ void TargetEntity::drawHealthBar(RenderDevice* rd, const Camera& camera, const F
 
 void TargetEntity::setDestinations(const Array<Destination> destinationArray) {
 	m_destinations = destinationArray;
+	destinationIdx = 0;
+	m_tangents.fastClear();
+	const int n = m_destinations.size();
+	if (!m_splinePath || n < 2) return;
+
+	// Catmull-Rom tangents (central differences w/ time), closed loops wrap around the duplicated end point
+	const bool closed = n > 2 && m_destinations[0].position == m_destinations[n - 1].position;
+	m_tangents.resize(n);
+	for (int i = 0; i < n; i++) {
+		const Destination* prev = (i > 0) ? &m_destinations[i - 1] : nullptr;
+		const Destination* next = (i < n - 1) ? &m_destinations[i + 1] : nullptr;
+		SimTime dt = 0;
+		if (closed && (i == 0 || i == n - 1)) {
+			prev = &m_destinations[n - 2];
+			next = &m_destinations[1];
+			dt = (m_destinations[n - 1].time - prev->time) + (next->time - m_destinations[0].time);
+		}
+		else {
+			if (isNull(prev)) prev = &m_destinations[i];
+			if (isNull(next)) next = &m_destinations[i];
+			dt = next->time - prev->time;
+		}
+		m_tangents[i] = (dt > 0) ? (next->position - prev->position) / float(dt) : Vector3::zero();
+	}
+}
+
+int TargetEntity::findSegment(SimTime t) {
+	const int last = m_destinations.size() - 2;
+	// Playing forward this is (almost) always the current or next segment
+	const int first = min(destinationIdx, last);
+	for (int i = first; i <= min(first + 1, last); i++) {
+		if (t >= m_destinations[i].time && t < m_destinations[i + 1].time) {
+			destinationIdx = i;
+			return i;
+		}
+	}
+	// Wrap or seek, binary search for the last destination at or before t
+	const Destination* d = std::upper_bound(m_destinations.begin(), m_destinations.end(), t,
+		[](SimTime time, const Destination& dest) { return time < dest.time; });
+	destinationIdx = clamp(int(d - m_destinations.begin()) - 1, 0, last);
+	return destinationIdx;
+}
+
+Point3 TargetEntity::pathPosition(SimTime t) {
+	if (t <= m_destinations[0].time) return m_destinations[0].position;
+	if (t >= m_destinations.last().time) return m_destinations.last().position;
+
+	const int i = findSegment(t);
+	const Destination& currDest = m_destinations[i];
+	const Destination& nextDest = m_destinations[i + 1];
+	const float duration = float(nextDest.time - currDest.time);
+	if (duration <= 0.0f) return nextDest.position;			// Zero duration step, teleport
+	const float prog = float(t - currDest.time) / duration;		// Get the ratio of time in this step completed
+
+	if (!m_splinePath) {
+		return currDest.position + prog * (nextDest.position - currDest.position);
+	}
+	// Cubic Hermite basis w/ the Catmull-Rom tangents
+	const float p2 = prog * prog;
+	const float p3 = p2 * prog;
+	return (2.0f * p3 - 3.0f * p2 + 1.0f) * currDest.position + (p3 - 2.0f * p2 + prog) * duration * m_tangents[i] +
+		(-2.0f * p3 + 3.0f * p2) * nextDest.position + (p3 - p2) * duration * m_tangents[i + 1];
 }
 
 void TargetEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
+	if (!m_externalMotion) {
+		simulateMotion(absoluteTime, deltaTime);
+	}
+
+#ifdef DRAW_BOUNDING_SPHERES
+	// Draw a 1m sphere at this position
+	debugDraw(Sphere(m_frame, BOUNDING_SPHERE_RADIUS), 0.0f, Color4::clear(), Color3::black());
+#endif
+}
+
+void TargetEntity::simulateMotion(SimTime absoluteTime, SimTime deltaTime) {
+	m_motionTime = absoluteTime;
 	// Check whether we have any destinations yet...
 	if (m_destinations.size() < 2)
 		return;
 
 	if (m_spawnTime == 0) m_spawnTime = absoluteTime;
-	SimTime time = fmod(absoluteTime-m_spawnTime, getPathTime());			// Compute a local time (modulus the path time)
-	
-	// Check if its time to move to the next segment
-	while(time < m_destinations[destinationIdx].time || time >= m_destinations[destinationIdx+1].time) {
-		destinationIdx++;										// Increment the destination index
-		destinationIdx %= m_destinations.size();					// Wrap if time goes over (works well for looped paths)
-	}
-	
-	// Get the current and next destination index
-	Destination currDest = m_destinations[destinationIdx];
-	Destination nextDest = m_destinations[(destinationIdx + 1) % m_destinations.size()];
-
-	// Compute the position by interpolating
-	float duration = nextDest.time - currDest.time;			// Get the total time for this "step
-	duration = max(duration, 0.0f);							// In "wrap" case immediately teleport back to start (0 duration step)
-	
-	float prog = 1.0f;										// By default make the "full step"
-	if (duration > 0.0f) {
-		// Handle time "wrap" case here
-		if (nextDest.time < time) {
-			time -= getPathTime();							// Fix the "wrap" math for prog below
+	const SimTime time = fmod(absoluteTime-m_spawnTime, getPathTime());		// Compute a local time (modulus the path time)
+	setFrame(pathPosition(time) + m_offset);									// Set the new positions
+}
+
+SimTime TargetEntity::predictionTime(SimTime t) const {
+	return clamp(t, m_motionTime, max(m_motionTime, predictionHorizon()));
+}
+
+Point3 TargetEntity::predictPosition(SimTime t) {
+	if (m_destinations.size() < 2 || m_spawnTime == 0) return motionPosition();
+	const SimTime time = fmod(max(t, m_spawnTime) - m_spawnTime, getPathTime());
+	return pathPosition(time) + m_offset;
+}
+
+SimTime TargetEntity::predictionHorizon() const {
+	// Paths are fixed, so any time can be predicted once the path has started
+	return (m_destinations.size() < 2 || m_spawnTime == 0) ? m_motionTime : (SimTime)finf();
+}
+
+/** Time from now until a target at pos moving w/ velocity leaves the bounds (0 if it already is moving out of them) */
+static SimTime timeToLeave(const AABox& bounds, const Point3& pos, const Vector3& velocity, bool ignoreY = false) {
+	SimTime t = finf();
+	for (int a = 0; a < 3; a++) {
+		if (ignoreY && a == 1) continue;
+		if (velocity[a] > 0.0f) {
+			t = min(t, (SimTime)max(0.0f, (bounds.high()[a] - pos[a]) / velocity[a]));
+		}
+		else if (velocity[a] < 0.0f) {
+			t = min(t, (SimTime)max(0.0f, (bounds.low()[a] - pos[a]) / velocity[a]));
 		}
-		prog = (nextDest.time - time) / duration;			// Get the ratio of time in this step completed
 	}
-	
-	Point3 delta = currDest.position - nextDest.position; 	// Get the delta vector to move along
-	setFrame((prog*delta) + currDest.position + m_offset);	// Set the new positions
-
-#ifdef DRAW_BOUNDING_SPHERES
-	// Draw a 1m sphere at this position
-	debugDraw(Sphere(m_frame, BOUNDING_SPHERE_RADIUS), 0.0f, Color4::clear(), Color3::black());
-#endif
+	return t;
 }
 
 shared_ptr<Entity> FlyingEntity::create(
@@ -172,13 +330,14 @@ shared_ptr<FlyingEntity> FlyingEntity::create(
 }
 
 shared_ptr<FlyingEntity> FlyingEntity::create(
-	shared_ptr<TargetConfig>		config,
+	shared_ptr<const TargetConfig>		config,
 	const String&					name,
 	Scene*							scene,
 	const shared_ptr<Model>&		model,
 	const Point3&					orbitCenter,
 	int								scaleIdx,
-	int								paramIdx)
+	int								paramIdx,
+	const CounterRandom&			rng)
 {
 	// Don't initialize in the constructor, where it is unsafe to throw Any parse exceptions
 	const shared_ptr<FlyingEntity>& flyingEntity = createShared<FlyingEntity>();
@@ -186,7 +345,17 @@ shared_ptr<FlyingEntity> FlyingEntity::create(
 	// Initialize each base class, which parses its own fields
 	flyingEntity->Entity::init(name, scene, CFrame(), shared_ptr<Entity::Track>(), true, true);
 	flyingEntity->VisibleEntity::init(model, true, Surface::ExpressiveLightScatteringProperties(), ArticulatedModel::PoseSpline());
-	flyingEntity->FlyingEntity::init(
+	flyingEntity->m_scaleIdx = scaleIdx;
+	flyingEntity->reinit(config, name, orbitCenter, paramIdx, rng);
+	return flyingEntity;
+}
+
+void FlyingEntity::reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& orbitCenter, int paramIdx, const CounterRandom& rng) {
+	resetSpawnState(name, config->id, rng);
+	m_speed = 0.0f;
+	m_destinationPoints.fastClear();
+	m_segments.fastClear();
+	FlyingEntity::init(
 		{ config->speed[0], config->speed[1] }, 
 		{ config->motionChangePeriod[0], config->motionChangePeriod[1] },
 		config->upperHemisphereOnly, 
@@ -194,10 +363,8 @@ shared_ptr<FlyingEntity> FlyingEntity::create(
 		paramIdx, 
 		config->axisLock, 
 		config->respawnCount, 
-		scaleIdx, 
+		m_scaleIdx, 
 		config->logTargetTrajectory);
-	flyingEntity->m_id = config->id;
-	return flyingEntity;
 }
 
 
@@ -229,6 +396,7 @@ void FlyingEntity::init(Vector2 angularSpeedRange, Vector2 motionChangePeriodRan
 
 void FlyingEntity::setDestinations(const Array<Point3>& destinationArray, const Point3 orbitCenter) {
 	m_destinationPoints.fastClear();
+	m_segments.fastClear();
 	if (destinationArray.size() > 0) {
 		const float distance = (destinationArray[0] - orbitCenter).length();
 
@@ -267,17 +435,32 @@ void FlyingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 
 	simulatePose(absoluteTime, deltaTime);
 
-	if (m_worldSpace) {
+	if (!m_externalMotion) {
+		simulateMotion(absoluteTime, deltaTime);
+	}
+
+#ifdef DRAW_BOUNDING_SPHERES
+	// Draw a 1m sphere at this position
+	debugDraw(Sphere(m_frame.translation, BOUNDING_SPHERE_RADIUS), 0.0f, Color4::clear(), Color3::black());
+#endif
+}
+
+void FlyingEntity::simulateMotion(SimTime absoluteTime, SimTime deltaTime) {
+	m_motionTime = absoluteTime;
+	if (m_worldSpace && m_motionBatchIdx >= 0) {
+		// Motion is advanced (with other world-space targets) by a WorldMotionBatch
+	}
+	else if (m_worldSpace) {
 		Point3 pos = m_frame.translation;
 		// Handle world-space target here
 		// Check for change in direction
 		if (absoluteTime > m_nextChangeTime) {
 			// Update the next change time
-			float motionChangeTime = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+			float motionChangeTime = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
 			m_nextChangeTime = absoluteTime + motionChangeTime;
 			// Velocity to use for this next interval
-			float vel = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
-			Point3 destination = m_bounds.randomInteriorPoint();
+			float vel = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+			Point3 destination = m_rng.randomInteriorPoint(m_bounds);
 			if (m_axisLocks[0]) {
 				destination.x = pos.x;
 			}
@@ -320,94 +503,154 @@ void FlyingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		setFrame(pos);
 	}
 	else {
-		// Handle non-world space (player projection here)
-		while ((deltaTime > 0.000001f) && m_angularSpeedRange[0] > 0.0f) {
-			if (m_destinationPoints.empty()) {
-				// Add destimation points if no destination points.
-				float motionChangePeriod = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
-				float angularSpeed = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
-				float angularDistance = motionChangePeriod * angularSpeed;
-				angularDistance = angularDistance > 170.f ? 170.0f : angularDistance; // replace with 170 deg if larger than 170.
-
-				// [m/s] = [m/radians] * [radians/s]
-				const float radius = (m_frame.translation - m_orbitCenter).length();
-				m_speed = radius * (angularSpeed * pif() / 180.0f);
-
-				// relative position to orbit center
-				Point3 relPos = m_frame.translation - m_orbitCenter;
-				// find a vector perpendicular to the current position
-				Point3 perpen = findPerpendicularVector(relPos);
-				// calculate destination point
-				Point3 dest = m_orbitCenter + rotateToward(relPos, perpen, angularDistance);
-				// add destination point.
-				m_destinationPoints.pushBack(dest);
+		// Handle non-world space (player projection here), motion is a chain of great-circle arcs evaluated in closed form
+		if (m_angularSpeedRange[0] > 0.0f) {
+			if (m_segments.empty()) {
+				appendSegment(m_frame.translation, absoluteTime - deltaTime);
 			}
-
-			if ((m_frame.translation - m_destinationPoints[0]).length() < 0.001f) {
-				// Retire this destination. We are almost at the destination (linear and geodesic distances 
-				// are the same when small), and the following math will be numerically imprecise if we
-				// use such a close destination.
-				m_destinationPoints.popFront();
+			setFrame(positionAt(absoluteTime));
+			// Retire completed arcs
+			while (m_segments.size() > 1 && m_segments[0].endTime() <= absoluteTime) {
+				m_segments.popFront();
 			}
-			else {
-				const Point3 destinationPoint = m_destinationPoints[0];
-				const Point3 currentPoint = m_frame.translation;
-
-				// Transform to directions
-				const float radius = (destinationPoint - m_orbitCenter).length();
-				const Vector3& destinationVector = (destinationPoint - m_orbitCenter).direction();
-				const Vector3& currentVector = (currentPoint - m_orbitCenter).direction();
-
-				// The direction is always "from current to destination", so we can use acos here
-				// and not worry about it being unsigned.
-				const float projection = currentVector.dot(destinationVector);
-				const float destinationAngle = G3D::acos(projection);
-
-				// [radians/s] = [m/s] / [m/radians]
-				const float angularSpeed = m_speed / radius;
-
-				// [rad] = [rad/s] * [s] 
-				float angleChange = angularSpeed * deltaTime;
-
-				if (angleChange > destinationAngle) {
-					// We'll reach the destination before the time step ends.
-					// Record how much time was consumed by this step.
-					deltaTime -= destinationAngle / angularSpeed;
-					angleChange = destinationAngle;
-					m_destinationPoints.popFront();
-				}
-				else {
-					// Consumed the entire time step
-					deltaTime = 0;
-				}
+		}
+	}
+}
 
-				// Transform to spherical coordinates in the plane of the arc
-				const Vector3& U = currentVector;
-				const Vector3& V = (destinationVector - currentVector * projection).direction();
 
-				setFrame(m_orbitCenter + (cos(angleChange) * U + sin(angleChange) * V) * radius);
-			}
+void FlyingEntity::appendSegment(const Point3& start, SimTime startTime) {
+	OrbitSegment seg;
+	const Vector3 relPos = start - m_orbitCenter;
+	seg.radius = relPos.length();
+	seg.U = relPos / seg.radius;
+	seg.startTime = startTime;
+
+	// Arc to the next given destination (if any) at the current speed
+	while (m_destinationPoints.size() > 0) {
+		const Vector3 destinationVector = (m_destinationPoints.popFront() - m_orbitCenter).direction();
+		const float projection = seg.U.dot(destinationVector);
+		const float destinationAngle = G3D::acos(projection);
+		if (destinationAngle * seg.radius < 0.001f) continue;		// Already there (the direction below would be imprecise)
+		seg.V = (destinationVector - seg.U * projection).direction();
+		// [radians/s] = [m/s] / [m/radians]
+		seg.angularSpeed = m_speed / seg.radius;
+		seg.duration = destinationAngle / seg.angularSpeed;
+		m_segments.pushBack(seg);
+		return;
+	}
 
-			if (m_upperHemisphereOnly) {
-				// Target position must be always above the orbit horizon (plane defined by "y = m_orbitCenter.y")
-				// If target is below the orbit horizon, y-invert position & destination points w.r.t. the orbit horizon.
-				if (m_frame.translation.y < m_orbitCenter.y) {
-					m_frame.translation.y = m_orbitCenter.y + (m_orbitCenter.y - m_frame.translation.y);
-					for (int i = 0; i < m_destinationPoints.length(); ++i) { // iterate by the number of elements in m_destinationPoints.
-						Point3 t_dp = m_destinationPoints.popFront(); // pop first element.
-						t_dp.y = m_orbitCenter.y + (m_orbitCenter.y - t_dp.y);
-						m_destinationPoints.pushBack(t_dp); // push the newly processed destination points at the back.
-					}
-				}
-			}
+	// Otherwise a random arc
+	const float motionChangePeriod = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+	const float angularSpeed = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+	const float angularDistance = min(motionChangePeriod * angularSpeed, 170.0f);		// Limit to 170 deg
+	seg.angularSpeed = angularSpeed * pif() / 180.0f;
+	seg.duration = (angularDistance * pif() / 180.0f) / seg.angularSpeed;
+	alwaysAssertM(seg.duration > 0, "Moving targets must have a positive motion change period!");
+	seg.V = findPerpendicularVector(seg.U, m_rng);		// Unit length (as U is)
+	// [m/s] = [m/radians] * [radians/s]
+	m_speed = seg.radius * seg.angularSpeed;
+	m_segments.pushBack(seg);
+}
+
+Point3 FlyingEntity::evaluate(const OrbitSegment& segment, SimTime t) const {
+	Point3 pos = m_orbitCenter + segment.offsetAt(t);
+	if (m_upperHemisphereOnly && pos.y < m_orbitCenter.y) {
+		// Target position must be always above the orbit horizon (plane defined by "y = m_orbitCenter.y"),
+		// folding the arc about the horizon is equivalent to y-inverting the position and destination whenever it crosses
+		pos.y = m_orbitCenter.y + (m_orbitCenter.y - pos.y);
+	}
+	return pos;
+}
+
+Point3 FlyingEntity::predictPosition(SimTime t) {
+	if (m_worldSpace) {
+		return motionPosition() + m_velocity * float(predictionTime(t) - m_motionTime);
+	}
+	if (m_segments.empty()) return motionPosition();
+	t = clamp(t, m_segments[0].startTime, m_segments.last().endTime());
+	int i = 0;
+	while (m_segments[i].endTime() < t) i++;
+	return evaluate(m_segments[i], t);
+}
+
+SimTime FlyingEntity::predictionHorizon() const {
+	if (m_worldSpace) {
+		// Straight line motion until the next direction change or bounds reflection
+		return min(m_nextChangeTime, m_motionTime + timeToLeave(m_bounds, motionPosition(), m_velocity));
+	}
+	if (m_angularSpeedRange[0] <= 0.0f) return finf();		// Static
+	return m_segments.empty() ? m_motionTime : m_segments.last().endTime();
+}
+
+Point3 FlyingEntity::positionAt(SimTime t) {
+	if (m_segments.empty()) return m_frame.translation;
+	// Plan ahead until the last arc covers t (arcs only depend on the previous arc's end, so planning early doesn't change motion)
+	while (m_segments.last().endTime() < t) {
+		const OrbitSegment& last = m_segments.last();
+		appendSegment(evaluate(last, last.endTime()), last.endTime());
+	}
+	int i = 0;
+	while (m_segments[i].endTime() < t) i++;
+	return evaluate(m_segments[i], t);
+}
+
+float JumpingEntity::playerJumpRemaining() const {
+	// Positive solution of 0 = a * t ^ 2 + 2 * v * t + (y - y0) (see simulateMotion)
+	return -m_speed.y / m_acc.y
+		- sqrtf(m_speed.y * m_speed.y - m_acc.y * m_simulatedPos.y + m_acc.y * m_standingHeight) / m_acc.y;
+}
+
+Point3 JumpingEntity::predictPosition(SimTime t) {
+	if (m_isFirstFrame) return motionPosition();
+	const float dt = float(predictionTime(t) - m_motionTime);
+
+	if (m_worldSpace) {
+		Point3 pos = motionPosition() + m_velocity * dt;
+		if (m_inJump) {
+			const float jt = float(m_motionTime - m_jumpTime) + dt;
+			pos.y = m_standingHeight + 0.5f * m_acc.y * jt * jt + m_jumpSpeed * jt;
 		}
+		return pos;
 	}
-#ifdef DRAW_BOUNDING_SPHERES
-	// Draw a 1m sphere at this position
-	debugDraw(Sphere(m_frame.translation, BOUNDING_SPHERE_RADIUS), 0.0f, Color4::clear(), Color3::black());
-#endif
+
+	// Planar distance, mid-jump the planar speed accelerates until it reaches its goal (where it is then held)
+	float d = m_speed.x * dt;
+	if (m_inJump && m_acc.x != 0.0f) {
+		const bool pushesPastGoal = (m_planarSpeedGoal > 0) ? (m_acc.x > 0) : (m_acc.x < 0);
+		const float toGoal = (m_planarSpeedGoal - m_speed.x) / m_acc.x;
+		if (pushesPastGoal && toGoal >= 0.0f && toGoal < dt) {
+			d = m_speed.x * toGoal + 0.5f * m_acc.x * toGoal * toGoal + m_planarSpeedGoal * (dt - toGoal);
+		}
+		else {
+			d += 0.5f * m_acc.x * dt * dt;
+		}
+	}
+
+	// Rotate about the orbit center (as in simulateMotion), then add the jump height and project onto the orbit sphere
+	const Point3 planarCenter = Point3(m_orbitCenter.x, m_standingHeight, m_orbitCenter.z);
+	const Point3 planarPos = Point3(m_simulatedPos.x, m_standingHeight, m_simulatedPos.z);
+	const float radius = (planarPos - planarCenter).length();
+	const float angle = d / radius;
+	const Vector3 U = (planarPos - planarCenter).direction();
+	const Vector3 V = U.cross(Vector3(0.f, 1.f, 0.f));
+	const Point3 o = m_orbitCenter + (cos(angle) * U + sin(angle) * V) * radius;
+	Point3 simulated(o.x, m_simulatedPos.y, o.z);
+	if (m_inJump) {
+		simulated.y += m_speed.y * dt + 0.5f * m_acc.y * dt * dt;
+	}
+	return (simulated - m_orbitCenter).direction() * m_orbitRadius + m_orbitCenter;
 }
 
+SimTime JumpingEntity::predictionHorizon() const {
+	if (m_isFirstFrame) return m_motionTime;
+	if (m_worldSpace) {
+		// The next direction change, jump start/end or bounds reflection (jumps may leave the bounds vertically)
+		SimTime horizon = min(m_nextChangeTime, m_motionTime + timeToLeave(m_moveBounds, motionPosition(), m_velocity, m_inJump));
+		return min(horizon, m_inJump ? m_jumpTime + worldJumpDuration() : m_nextJumpTime);
+	}
+	// The next motion change or jump start/end
+	return m_motionTime + min(m_motionChangeTimer, m_inJump ? playerJumpRemaining() : m_jumpTimer);
+}
 
 shared_ptr<Entity> JumpingEntity::create(
 	const String&                  name,
@@ -431,14 +674,15 @@ shared_ptr<Entity> JumpingEntity::create(
 }
 
 shared_ptr<JumpingEntity> JumpingEntity::create(
-	shared_ptr<TargetConfig>		config,
+	shared_ptr<const TargetConfig>		config,
 	const String&					name,
 	Scene*							scene,
 	const shared_ptr<Model>&		model,
 	int								scaleIdx,
 	const Point3&					orbitCenter,
 	float							targetDistance,
-	int								paramIdx)
+	int								paramIdx,
+	const CounterRandom&			rng)
 {
 	// Don't initialize in the constructor, where it is unsafe to throw Any parse exceptions
 	const shared_ptr<JumpingEntity>& jumpingEntity = createShared<JumpingEntity>();
@@ -446,7 +690,17 @@ shared_ptr<JumpingEntity> JumpingEntity::create(
 	// Initialize each base class, which parses its own fields
 	jumpingEntity->Entity::init(name, scene, CFrame(), shared_ptr<Entity::Track>(), true, true);
 	jumpingEntity->VisibleEntity::init(model, true, Surface::ExpressiveLightScatteringProperties(), ArticulatedModel::PoseSpline());
-	jumpingEntity->JumpingEntity::init(
+	jumpingEntity->m_scaleIdx = scaleIdx;
+	jumpingEntity->reinit(config, name, orbitCenter, targetDistance, paramIdx, rng);
+	return jumpingEntity;
+}
+
+void JumpingEntity::reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& orbitCenter, float targetDistance, int paramIdx, const CounterRandom& rng) {
+	resetSpawnState(name, config->id, rng);
+	m_isFirstFrame = true;
+	m_nextJumpTime = 0;
+	m_acc = Point2::zero();
+	JumpingEntity::init(
 		{ config->speed[0], config->speed[1] },
 		{ config->motionChangePeriod[0], config->motionChangePeriod[1] },
 		{ config->jumpPeriod[0], config->jumpPeriod[1] },
@@ -458,11 +712,8 @@ shared_ptr<JumpingEntity> JumpingEntity::create(
 		paramIdx,
 		config->axisLock,
 		config->respawnCount,
-		scaleIdx,
+		m_scaleIdx,
 		config->logTargetTrajectory);
-	jumpingEntity->m_id = config->id;
-
-	return jumpingEntity;
 }
 
 
@@ -506,9 +757,9 @@ void JumpingEntity::init(
 		m_axisLocks[i] = axisLock[i];
 	}
 	m_orbitRadius = orbitRadius;
-	float angularSpeed = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+	float angularSpeed = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
 	m_planarSpeedGoal = m_orbitRadius * (angularSpeed * pif() / 180.0f);
-	if (Random::common().uniform() > 0.5f) {
+	if (m_rng.uniform() > 0.5f) {
 		m_planarSpeedGoal = -m_planarSpeedGoal;
 	}
 	// [m/s] = [m/radians] * [radians/s]
@@ -516,8 +767,8 @@ void JumpingEntity::init(
 	m_speed.y = 0.0f;
 
 	m_inJump = false;
-	m_motionChangeTimer = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
-	m_jumpTimer = Random::common().uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
+	m_motionChangeTimer = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+	m_jumpTimer = m_rng.uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
 }
 
 Any JumpingEntity::toAny(const bool forceAll) const {
@@ -535,12 +786,24 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 
 	simulatePose(absoluteTime, deltaTime);
 
+	if (!m_externalMotion) {
+		simulateMotion(absoluteTime, deltaTime);
+	}
+
+#ifdef DRAW_BOUNDING_SPHERES
+	// Draw a 1m sphere at this position
+	debugDraw(Sphere(m_frame.translation, BOUNDING_SPHERE_RADIUS), 0.0f, Color4::clear(), Color3::black());
+#endif
+}
+
+void JumpingEntity::simulateMotion(SimTime absoluteTime, SimTime deltaTime) {
+	m_motionTime = absoluteTime;
 	if (m_isFirstFrame) {
 		m_simulatedPos = m_frame.translation;
 		m_standingHeight = m_frame.translation.y;
 		m_isFirstFrame = false;
-		m_acc.y = -Random::common().uniform(m_gravityRange[0], m_gravityRange[1]);
-		m_jumpSpeed = Random::common().uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
+		m_acc.y = -m_rng.uniform(m_gravityRange[0], m_gravityRange[1]);
+		m_jumpSpeed = m_rng.uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
 	}
 
 	if (m_worldSpace) {
@@ -549,11 +812,11 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		// Check for time for motion (direction) change
 		if (absoluteTime > m_nextChangeTime) {
 			// Update the next change time
-			float motionChangeTime = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+			float motionChangeTime = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
 			m_nextChangeTime = absoluteTime + motionChangeTime;
 			// Velocity to use for this next interval
-			float vel = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
-			Point3 destination = m_moveBounds.randomInteriorPoint();
+			float vel = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+			Point3 destination = m_rng.randomInteriorPoint(m_moveBounds);
 			if (m_axisLocks[0]) {
 				destination.x = frame().translation.x;
 			}
@@ -593,20 +856,18 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 		// Check for jump condition
 		if (m_inJump) {
 			SimTime dt = absoluteTime - m_jumpTime;
-			float jumpTime = -m_jumpSpeed / m_acc.y
-				- sqrtf(m_jumpSpeed*m_jumpSpeed - m_acc.y * pos.y + m_acc.y * m_standingHeight) / m_acc.y;
 			// Check if jump is over (time-based)
-			if (dt > jumpTime) {
+			if (dt > worldJumpDuration()) {
 				m_inJump = false;
 				m_jumpTime = 0;
 				pos.y = m_standingHeight;		// Reset to the original height
 				// Schedule the next jump here
-				float nextJump = Random::common().uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
+				float nextJump = m_rng.uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
 				m_nextJumpTime = absoluteTime + nextJump;
 			}
 			else {
-				// Attempt jump simulation here
-				pos.y += 0.5f * m_acc.y * dt * dt + m_jumpSpeed * dt;
+				// Ballistic height above the standing height
+				pos.y = m_standingHeight + 0.5f * m_acc.y * float(dt * dt) + m_jumpSpeed * float(dt);
 			}
 		}
 
@@ -677,7 +938,7 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 
 			/// Update motion state (includes updating acceleration)
 			if (t == m_motionChangeTimer) { // changing motion direction
-				float new_AngularSpeedGoal = Random::common().uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
+				float new_AngularSpeedGoal = m_rng.uniform(m_angularSpeedRange[0], m_angularSpeedRange[1]);
 				float new_planarSpeedGoal = m_orbitRadius * (new_AngularSpeedGoal * pif() / 180.0f);
 				// change direction
 				if (m_planarSpeedGoal > 0) {
@@ -691,7 +952,7 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 				else { // if not in jump, immediately apply direction change
 					m_speed.x = m_planarSpeedGoal;
 				}
-				m_motionChangeTimer = Random::common().uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
+				m_motionChangeTimer = m_rng.uniform(m_motionChangePeriodRange[0], m_motionChangePeriodRange[1]);
 			}
 			if (t == nextJumpStateChange) { // either starting or finishing jump
 				if (m_inJump) { // finishing jump
@@ -699,13 +960,13 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 					m_acc.y = 0; // remove gravity effect
 					m_speed.x = m_planarSpeedGoal; // instantly gain the running speed. (general behavior in games)
 					m_inJump = false;
-					m_jumpTimer = Random::common().uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
+					m_jumpTimer = m_rng.uniform(m_jumpPeriodRange[0], m_jumpPeriodRange[1]);
 				}
 				else { // starting jump
 					m_acc.x = sign(m_planarSpeedGoal) * m_planarAcc;
-					float gravity = -Random::common().uniform(m_gravityRange[0], m_gravityRange[1]);
-					float jumpSpeed = Random::common().uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
-					float distance = Random::common().uniform(m_distanceRange[0], m_distanceRange[1]);
+					float gravity = -m_rng.uniform(m_gravityRange[0], m_gravityRange[1]);
+					float jumpSpeed = m_rng.uniform(m_jumpSpeedRange[0], m_jumpSpeedRange[1]);
+					float distance = m_rng.uniform(m_distanceRange[0], m_distanceRange[1]);
 					m_acc.y = gravity * m_orbitRadius / distance;
 					m_speed.y = jumpSpeed * m_orbitRadius / distance;
 					m_planarAcc = m_acc.y / 3.f;
@@ -719,9 +980,5 @@ void JumpingEntity::onSimulation(SimTime absoluteTime, SimTime deltaTime) {
 			m_motionChangeTimer -= t;
 		}
 	}
-#ifdef DRAW_BOUNDING_SPHERES
-	// Draw a 1m sphere at this position
-	debugDraw(Sphere(m_frame.translation, BOUNDING_SPHERE_RADIUS), 0.0f, Color4::clear(), Color3::black());
-#endif
 }
 
@@ -1,6 +1,6 @@
 #pragma once
 #include <G3D/G3D.h>
-
+#include "CounterRandom.h"
 
 class TargetConfig;
 
@@ -10,6 +10,21 @@ class TargetConfig;
 // Scale and offset for target
 const float TARGET_MODEL_ARRAY_SCALING = 0.2f;
 const float TARGET_MODEL_ARRAY_OFFSET = 20;
+const int TARGET_MODEL_SCALE_COUNT = 30;			///< Number of model scale indices (see TargetModelTable)
+
+/** Generational handle to a target in the session's target registry.
+	A handle becomes stale (and lookups return null) once its target is destroyed, even if the slot is reused. */
+struct TargetHandle {
+	int		index = -1;						///< Slot index in the registry
+	uint32	generation = 0;					///< Slot generation when this handle was issued
+
+	TargetHandle() {}
+	TargetHandle(int idx, uint32 gen) : index(idx), generation(gen) {}
+
+	bool isValid() const { return index >= 0; }
+	bool operator==(const TargetHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const TargetHandle& other) const { return !(*this == other); }
+};
 
 struct Destination{
 public:
@@ -68,15 +83,36 @@ protected:
 	bool	m_isLogged			= true;				///< Control flag for logging
 	Point3	m_offset;								///< Offset for initial spawn
 	Array<Destination> m_destinations;				///< Array of destinations to visit
+	Array<Vector3> m_tangents;						///< Path velocity at each destination (for spline interpolation)
+	bool	m_splinePath		= false;			///< Interpolate destinations w/ a Catmull-Rom spline (otherwise linearly)
+	bool	m_baked				= false;			///< Is the path pre-simulated (baked) parametric motion?
 	shared_ptr<Sound> m_hitSound;					///< Sound to play when hit
+	String m_hitSoundFilename;						///< Filename m_hitSound was loaded from
 	float m_hitSoundVol;							///< Volume to play hit sound at
 	shared_ptr<Sound> m_destroyedSound;				///< Sound to play when destroyed
+	String m_destroyedSoundFilename;				///< Filename m_destroyedSound was loaded from
 	float m_destroyedSoundVol;						///< Volume to play destroyed sound at
+	CounterRandom m_rng;							///< Per-target random stream (all motion randomness comes from here)
+	TargetHandle m_handle;							///< Handle in the session target registry (invalid if not registered)
+	int m_motionBatchIdx = -1;						///< Index in a batched motion system (-1 if simulated by onSimulation)
+	bool m_externalMotion = false;					///< Motion is advanced by the session (TargetClock/TargetWorkerPool), not in onSimulation
+	Point3 m_stepFrom;								///< Simulated position before the latest fixed-rate step
+	Point3 m_stepTo;								///< Simulated position after the latest fixed-rate step
+	bool m_interpolated = false;					///< The frame holds an interpolated (display) position, m_stepTo is the simulated one
+	SimTime m_motionTime = 0;						///< Time of the latest motion update
 
 	// Only used for flying/jumping entities
 	SimTime m_nextChangeTime = 0;
 	Vector3 m_velocity = Vector3::zero();
 
+	/** Index of the destination segment containing path time t (checks the cached index first, then binary searches) */
+	int findSegment(SimTime t);
+	/** Clamp a prediction time to [m_motionTime, predictionHorizon()] */
+	SimTime predictionTime(SimTime t) const;
+
+	/** Reset the per-spawn state shared by all target types (used when reusing a pooled target) */
+	void resetSpawnState(const String& name, const String& id, const CounterRandom& rng);
+
 public:
 	TargetEntity() {}
 
@@ -91,13 +127,47 @@ public:
 	);
 
 	static shared_ptr<TargetEntity> create(
-		shared_ptr<TargetConfig>		config,
+		shared_ptr<const TargetConfig>		config,
 		const String&					name,
 		Scene*							scene,
 		const shared_ptr<Model>&		model,
 		const Point3&					offset,
 		int								scaleIdx,
-		int								paramIdx
+		int								paramIdx,
+		const CounterRandom&			rng
+	);
+
+	/** Reinitialize this target from a config for a new spawn (the model/scale index are unchanged) */
+	void reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& offset, int paramIdx, const CounterRandom& rng);
+	/** Reinitialize this target from a config for a new spawn, following path (e.g. a baked trajectory) rather than the config's destinations */
+	void reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& offset, int paramIdx, const CounterRandom& rng, const Array<Destination>& path);
+
+	/** Create a target of the type a config calls for (baked/destination targets, jumping or flying w/ their world space bounds).
+		The target is placed for a spawn (and can be reused for later spawns) by spawnFromConfig(). */
+	static shared_ptr<TargetEntity> createFromConfig(
+		shared_ptr<const TargetConfig>	config,
+		const String&					name,
+		Scene*							scene,
+		const shared_ptr<Model>&		model,
+		int								scaleIdx,
+		int								paramIdx,
+		float							targetDistance,
+		const CounterRandom&			rng
+	);
+
+	/** Reinitialize a target made by createFromConfig() for a spawn and move it to its spawn position (which is returned).
+		Player space targets orbit orbitCenter from playerSpacePos, world space targets start at worldSpawnPos, baked targets follow bakedPath. */
+	static Point3 spawnFromConfig(
+		const shared_ptr<TargetEntity>&	target,
+		shared_ptr<const TargetConfig>	config,
+		const String&					name,
+		int								paramIdx,
+		const CounterRandom&			rng,
+		const Point3&					orbitCenter,
+		float							targetDistance,
+		const Point3&					playerSpacePos,
+		const Point3&					worldSpawnPos,
+		const Array<Destination>&		bakedPath
 	);
 
 	void init(Array<Destination> dests, int paramIdx, Point3 staticOffset = Point3(0.0, 0.0, 0.0), int respawnCount = 0, int scaleIdx = 0, bool isLogged = true) {
@@ -107,17 +177,12 @@ public:
 		m_scaleIdx = scaleIdx;
 		m_isLogged = isLogged;
 		destinationIdx = 0;
+		setDestinations(dests);
 	}
 
-	void setColor(const Color3& color) {
-		UniversalMaterial::Specification materialSpecification;
-		materialSpecification.setLambertian(Texture::Specification(color));
-		materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
-		materialSpecification.setGlossy(Texture::Specification(Color4(0.4f, 0.2f, 0.1f, 0.8f)));
-
-		const shared_ptr<ArticulatedModel::Pose>& amPose = ArticulatedModel::Pose::create();
-		amPose->materialTable.set("core/icosahedron_default", UniversalMaterial::create(materialSpecification));
-		setPose(amPose);
+	/** Color this target w/ a (shared) pose from a TargetPalette, does nothing if the pose is already set */
+	void setPalettePose(const shared_ptr<ArticulatedModel::Pose>& pose) {
+		if (m_pose != pose) setPose(pose);
 	}
 
 	void setWorldSpace(bool worldSpace) { m_worldSpace = worldSpace; }
@@ -125,17 +190,24 @@ public:
 	void setHitSound(const String& hitSoundFilename, float hitSoundVol = 1.0f) {
 		if (hitSoundFilename == "") { m_hitSound = nullptr; }
 		else { 
-			m_hitSound = Sound::create(System::findDataFile(hitSoundFilename)); 
+			// Don't reload the sound if it hasn't changed (i.e. a pooled target being respawned)
+			if (isNull(m_hitSound) || hitSoundFilename != m_hitSoundFilename) {
+				m_hitSound = Sound::create(System::findDataFile(hitSoundFilename));
+			}
 			m_hitSoundVol = hitSoundVol;
 		}
+		m_hitSoundFilename = hitSoundFilename;
 	}
 
 	void setDestoyedSound(const String& destroyedSoundFilename, float destroyedSoundVol = 1.0f){
 		if (destroyedSoundFilename == "") { m_destroyedSound = nullptr;  }
 		else {
-			m_destroyedSound = Sound::create(System::findDataFile(destroyedSoundFilename));
+			if (isNull(m_destroyedSound) || destroyedSoundFilename != m_destroyedSoundFilename) {
+				m_destroyedSound = Sound::create(System::findDataFile(destroyedSoundFilename));
+			}
 			m_destroyedSoundVol = destroyedSoundVol;
 		}
+		m_destroyedSoundFilename = destroyedSoundFilename;
 	}
 
 	void playHitSound(float volume=0.0f) {
@@ -170,7 +242,7 @@ public:
 		return true;					// Also returns true for any target w/ negative m_respawnCount
 	}
 
-	void resetMotionParams() {
+	virtual void resetMotionParams() {
 		m_nextChangeTime = 0;
 	}
 	
@@ -180,6 +252,8 @@ public:
 	int scaleIndex() const { return m_scaleIdx; }
 	/** Getter for logging */
 	bool isLogged() const { return m_isLogged; }
+	/** Is this target playing back a baked trajectory? */
+	bool isBaked() const { return m_baked; }
 	/** Getter for health */
 	float health() const { return m_health; }
 	/** Getter for the total time for a path*/
@@ -192,23 +266,81 @@ public:
 	int respawnsRemaining() const { return m_respawnCount; }
 	/** Getter for parmaeter index */
 	int paramIdx() const { return m_paramIdx; }
+	/** Per-target random stream */
+	CounterRandom& rng() { return m_rng; }
+	/** Handle in the session target registry */
+	const TargetHandle& handle() const { return m_handle; }
+	void setHandle(const TargetHandle& handle) { m_handle = handle; }
+	/** Index in a batched motion system (-1 when this target moves itself in onSimulation) */
+	int motionBatchIndex() const { return m_motionBatchIdx; }
+	void setMotionBatchIndex(int idx) { m_motionBatchIdx = idx; }
+
+	/** Have the session (a fixed-rate TargetClock and/or a TargetWorkerPool) rather than onSimulation advance this target's motion */
+	void setExternalMotion(bool external) { m_externalMotion = external; resetStep(); }
+	bool hasExternalMotion() const { return m_externalMotion; }
+	/** Fixed-rate stepping, the frame is interpolated between the simulated positions before/after the latest step */
+	void resetStep() { m_stepFrom = m_stepTo = m_frame.translation; m_interpolated = false; }
+	void restoreStep() { setFrame(m_stepTo); m_interpolated = false; }
+	void beginStep() { m_stepFrom = m_frame.translation; }
+	void endStep(float alpha) {
+		m_stepTo = m_frame.translation;
+		setFrame(m_stepFrom.lerp(m_stepTo, alpha));
+		m_interpolated = true;
+	}
+	/** Simulated position (the frame may hold an interpolated one between fixed-rate steps) */
+	const Point3& motionPosition() const { return m_interpolated ? m_stepTo : m_frame.translation; }
+	/** Time of the latest motion update */
+	SimTime motionTime() const { return m_motionTime; }
+
+	/** Position at time t computed analytically from the current motion state (no simulation steps are taken).
+		This is exact up to predictionHorizon(), later times are clamped to the horizon since motion past it depends
+		on events (random draws, bounds reflections) that have not happened yet. */
+	virtual Point3 predictPosition(SimTime t);
+	/** Latest time predictPosition() is exact for (end of the current motion segment) */
+	virtual SimTime predictionHorizon() const;
 
 	void drawHealthBar(RenderDevice* rd, const Camera& camera, const Framebuffer& framebuffer, Point2 size, Point3 offset, Point2 border, Array<Color4> colors, Color4 borderColor) const;
 	virtual void onSimulation(SimTime absoluteTime, SimTime deltaTime) override;
+	/** Advance this target's motion (from onSimulation, or by the session when motion is external) */
+	virtual void simulateMotion(SimTime absoluteTime, SimTime deltaTime);
 	void setDestinations(const Array<Destination> destinationArray);
+	/** Use Catmull-Rom (rather than linear) interpolation between destinations (call before setDestinations) */
+	void setSplinePath(bool spline) { m_splinePath = spline; }
+	/** Position along the destination path (without offset) at path time t */
+	Point3 pathPosition(SimTime t);
 
 };
 
+/** Great-circle arc about a flying target's orbit center, evaluated in closed form */
+struct OrbitSegment {
+	Vector3	U;								///< Direction (from the orbit center) at the start of the arc
+	Vector3	V;								///< Direction perpendicular to U, toward the end of the arc
+	float	radius = 0.0f;					///< Orbit radius (m)
+	float	angularSpeed = 0.0f;			///< Angular speed (rad/s)
+	SimTime	startTime = 0;					///< Time the arc starts
+	SimTime	duration = 0;					///< Time to traverse the arc
+
+	SimTime endTime() const { return startTime + duration; }
+
+	/** Offset from the orbit center at time t (clamped to the arc) */
+	Vector3 offsetAt(SimTime t) const {
+		const float angle = angularSpeed * float(clamp(t - startTime, (SimTime)0, duration));
+		return (cos(angle) * U + sin(angle) * V) * radius;
+	}
+};
+
 class FlyingEntity : public TargetEntity {
+	friend class WorldMotionBatch;
 protected:
 	float			m_speed = 0.0f;									///< Speed of the target (deg/s or m/s depending on space)
 	Point3			m_orbitCenter;									///< World space point at center of orbit
 	Vector2			m_angularSpeedRange = Vector2{ 0.0f, 4.0f };	///< Angular Speed Range(deg / s) x = min y = max
     Vector2			m_motionChangePeriodRange = Vector2{ 10000.0f, 10000.0f };	  ///< Motion Change period in seconds (x=min y=max)
     /** The target will move through these points along arcs around
-        m_orbitCenter at m_speed. As each point is hit, it is
-        removed from the queue.*/
+        m_orbitCenter at m_speed. Each point is removed from the queue
+        as its arc is planned (random arcs are planned once it is empty).*/
     Queue<Point3>	m_destinationPoints;
+	Queue<OrbitSegment> m_segments;								///< Current (front) and planned arcs (player space motion)
 
 	/** Limits flying target entity motion for the upper hemisphere only.
 		OnSimulation will y-invert target position & destination points
@@ -221,12 +353,20 @@ protected:
 	FlyingEntity() {}
     void init(AnyTableReader& propertyTable);
 
+	/** Plan the next arc, starting from start at startTime */
+	void appendSegment(const Point3& start, SimTime startTime);
+	/** Position on an arc at time t (folded into the upper hemisphere if required) */
+	Point3 evaluate(const OrbitSegment& segment, SimTime t) const;
+
 	void init();
 
 	void init(Vector2 angularSpeedRange, Vector2 motionChangePeriodRange, bool upperHemisphereOnly, Point3 orbitCenter, int paramIdx, Array<bool> axisLock, int respawns = 0, int scaleIdx=0, bool isLogged=true);
 
 public:
 
+	/** Reinitialize this target from a config for a new spawn (the model/scale index are unchanged) */
+	void reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& orbitCenter, int paramIdx, const CounterRandom& rng);
+
     /** Destinations must be no more than 170 degrees apart to avoid ambiguity in movement direction */
     void setDestinations(const Array<Point3>& destinationArray, const Point3 orbitCenter);
 
@@ -237,6 +377,18 @@ public:
 		m_speed = speed;
 	}
 
+	/** Player space position at time t (arcs up to t are planned as needed, times before the current arc are clamped to its start) */
+	Point3 positionAt(SimTime t);
+
+	/** Planned arcs (player space) or straight line motion up to the next direction change/bounds reflection (world space) */
+	virtual Point3 predictPosition(SimTime t) override;
+	virtual SimTime predictionHorizon() const override;
+
+	virtual void resetMotionParams() override {
+		TargetEntity::resetMotionParams();
+		m_segments.fastClear();
+	}
+
 	// TODO: After other implementations are complete.
     /** For deserialization from Any / loading from file */
     static shared_ptr<Entity> create (
@@ -256,13 +408,14 @@ public:
 	);
 
 	static shared_ptr<FlyingEntity> create(
-		shared_ptr<TargetConfig>		config,
+		shared_ptr<const TargetConfig>		config,
 		const String&					name,
 		Scene*							scene,
 		const shared_ptr<Model>&		model,
 		const Point3&					orbitCenter,
 		int								scaleIdx,
-		int								paramIdx
+		int								paramIdx,
+		const CounterRandom&			rng
 	);
 
 	/** Converts the current VisibleEntity to an Any.  Subclasses should
@@ -271,6 +424,7 @@ public:
     virtual Any toAny(const bool forceAll = false) const override;
     
     virtual void onSimulation(SimTime absoluteTime, SimTime deltaTime) override;
+    virtual void simulateMotion(SimTime absoluteTime, SimTime deltaTime) override;
 };
 
 
@@ -320,6 +474,11 @@ protected:
 
 	JumpingEntity() {}
 
+	/** Duration of a (world space) ballistic jump, from and back to the standing height */
+	float worldJumpDuration() const { return -2.0f * m_jumpSpeed / m_acc.y; }
+	/** Time remaining in the current (player space) jump */
+	float playerJumpRemaining() const;
+
 	void init(AnyTableReader& propertyTable);
 	void init();
 	void init(
@@ -346,6 +505,20 @@ public:
 
 	void setMoveBounds(AABox bounds) { m_moveBounds = bounds; }
 
+	const Point3& orbitCenter() const { return m_orbitCenter; }
+	float orbitRadius() const { return m_orbitRadius; }
+	bool inJump() const { return m_inJump; }
+	float standingHeight() const { return m_standingHeight; }
+	/** Position before projection onto the orbit sphere (player space motion) */
+	const Point3& simulatedPosition() const { return m_simulatedPos; }
+
+	/** Orbit (player space) or straight line (world space) motion w/ a ballistic jump, up to the next motion/jump state change */
+	virtual Point3 predictPosition(SimTime t) override;
+	virtual SimTime predictionHorizon() const override;
+
+	/** Reinitialize this target from a config for a new spawn (the model/scale index are unchanged) */
+	void reinit(shared_ptr<const TargetConfig> config, const String& name, const Point3& orbitCenter, float targetDistance, int paramIdx, const CounterRandom& rng);
+
 	/** For deserialization from Any / loading from file */
 	static shared_ptr<Entity> create (
 		const String&					name,
@@ -357,14 +530,15 @@ public:
 
 	/** For programmatic construction at runtime */
 	static shared_ptr<JumpingEntity> create(
-		shared_ptr<TargetConfig>		config,
+		shared_ptr<const TargetConfig>		config,
 		const String&					name,
 		Scene*							scene,
 		const shared_ptr<Model>&		model,
 		int								scaleIdx,
 		const Point3&					orbitCenter,
 		float							targetDistance,
-		int								paramIdx
+		int								paramIdx,
+		const CounterRandom&			rng
 	);
 
 	/** Converts the current VisibleEntity to an Any.  Subclasses should
@@ -373,5 +547,6 @@ public:
 	virtual Any toAny(const bool forceAll = false) const override;
 
 	virtual void onSimulation(SimTime absoluteTime, SimTime deltaTime) override;
+	virtual void simulateMotion(SimTime absoluteTime, SimTime deltaTime) override;
 
 };
@@ -0,0 +1,71 @@
+#include "TargetModelTable.h"
+#include "TargetEntity.h"
+#include "ModelCache.h"
+
+float TargetModelTable::scale(int scaleIdx) {
+	return pow(1.0f + TARGET_MODEL_ARRAY_SCALING, float(scaleIdx) - TARGET_MODEL_ARRAY_OFFSET);
+}
+
+void TargetModelTable::init(int scaleCount) {
+	m_entries.clear();
+	m_scaleCount = scaleCount;
+	m_loadedCount = 0;
+}
+
+void TargetModelTable::add(const String& id, const Any& spec, const String& explosionDecal, float explosionScale) {
+	Entry e;
+	e.spec = spec;
+	e.explosionScale = explosionScale;
+	e.explosionSpec = Any::parse(format(
+		"ArticulatedModel::Specification {\
+			filename = \"ifs/square.ifs\";\
+			preprocess = {\
+				transformGeometry(all(), Matrix4::scale(0.1, 0.1, 0.1));\
+				setMaterial(all(), UniversalMaterial::Specification{\
+					lambertian = Texture::Specification {\
+						filename = \"%s\";\
+						encoding = Color3(1, 1, 1);\
+					};\
+				});\
+			};\
+		}", explosionDecal.c_str()));
+
+	// Get the bounding box to scale to size rather than arbitrary factor (cached, so the model is only loaded if it changed)
+	const Vector3 extent = ModelCache::common().bounds(spec).extent();
+	logPrintf("%20s bounding box: [%2.2f, %2.2f, %2.2f]\n", id.c_str(), extent[0], extent[1], extent[2]);
+	e.defaultScale = 1.0f / extent[0];					// Setup scale so that default model is 1m across
+
+	e.models.resize(m_scaleCount);
+	e.explosions.resize(m_scaleCount);
+	m_entries.set(id, e);
+}
+
+TargetModelTable::Entry& TargetModelTable::entry(const String& id) {
+	Entry* e = m_entries.getPointer(id);
+	alwaysAssertM(notNull(e), format("No target model loaded for \"%s\"!", id.c_str()));
+	return *e;
+}
+
+const shared_ptr<ArticulatedModel>& TargetModelTable::model(const String& id, int scaleIdx) {
+	Entry& e = entry(id);
+	shared_ptr<ArticulatedModel>& model = e.models[scaleIdx];
+	if (isNull(model)) {
+		Any spec = e.spec;
+		spec.set("scale", scale(scaleIdx) * e.defaultScale);
+		model = ModelCache::common().get(spec);
+		m_loadedCount++;
+	}
+	return model;
+}
+
+const shared_ptr<ArticulatedModel>& TargetModelTable::explosion(const String& id, int scaleIdx) {
+	Entry& e = entry(id);
+	shared_ptr<ArticulatedModel>& model = e.explosions[scaleIdx];
+	if (isNull(model)) {
+		Any spec = e.explosionSpec;
+		spec.set("scale", 20.0 * scale(scaleIdx) * e.explosionScale);
+		model = ModelCache::common().get(spec);
+		m_loadedCount++;
+	}
+	return model;
+}
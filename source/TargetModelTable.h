@@ -0,0 +1,45 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Target (and destroy explosion) models for each target ID, by scale index.
+	Only the base model bounds are needed up front (to size the target), the scaled models are created (and cached)
+	the first time each scale is requested, so load time and memory follow the scales actually used. */
+class TargetModelTable {
+protected:
+	struct Entry {
+		Any										spec;					///< Target model specification (unscaled)
+		Any										explosionSpec;			///< Explosion model specification (unscaled)
+		float									defaultScale = 1.0f;	///< Scale that makes the target model 1m across
+		float									explosionScale = 1.0f;	///< Explosion scale (relative to target size)
+		Array<shared_ptr<ArticulatedModel>>		models;					///< Target models by scale index (null until used)
+		Array<shared_ptr<ArticulatedModel>>		explosions;				///< Explosion models by scale index (null until used)
+	};
+
+	Table<String, Entry>	m_entries;
+	int						m_scaleCount = 0;		///< Number of scale indices per ID
+	int						m_loadedCount = 0;		///< Number of scaled models created so far
+
+	Entry& entry(const String& id);
+
+public:
+	/** Scale factor for a scale index */
+	static float scale(int scaleIdx);
+
+	/** Clears the table and sets the number of scale indices per ID */
+	void init(int scaleCount);
+
+	/** Add a target ID (sizes it from the base model's cached bounds), replaces any existing models for this ID */
+	void add(const String& id, const Any& spec, const String& explosionDecal, float explosionScale);
+
+	bool contains(const String& id) const { return m_entries.containsKey(id); }
+
+	/** Target model for this ID/scale index (created on first use) */
+	const shared_ptr<ArticulatedModel>& model(const String& id, int scaleIdx);
+	/** Destroy explosion model for this ID/scale index (created on first use) */
+	const shared_ptr<ArticulatedModel>& explosion(const String& id, int scaleIdx);
+
+	int scaleCount() const { return m_scaleCount; }
+	int idCount() const { return m_entries.size(); }
+	/** Number of scaled (target and explosion) models created so far, out of 2 * idCount() * scaleCount() */
+	int loadedCount() const { return m_loadedCount; }
+};
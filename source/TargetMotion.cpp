@@ -0,0 +1,292 @@
+#include "TargetMotion.h"
+#include "TargetEntity.h"
+#include <emmintrin.h>
+
+void WorldMotionBatch::resizeLanes() {
+	const int lanes = (m_count + 3) & ~3;
+	for (Array<float>* lane : { &m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz, &m_loX, &m_loY, &m_loZ, &m_hiX, &m_hiY, &m_hiZ, &m_freeX, &m_freeY, &m_freeZ }) {
+		lane->resize(lanes, false);
+	}
+	m_nextChangeTime.resize(lanes, false);
+	for (int i = m_count; i < lanes; i++) {
+		clearLane(i);
+	}
+}
+
+void WorldMotionBatch::moveLane(int i, int j) {
+	m_px[j] = m_px[i];		m_py[j] = m_py[i];		m_pz[j] = m_pz[i];
+	m_vx[j] = m_vx[i];		m_vy[j] = m_vy[i];		m_vz[j] = m_vz[i];
+	m_loX[j] = m_loX[i];	m_loY[j] = m_loY[i];	m_loZ[j] = m_loZ[i];
+	m_hiX[j] = m_hiX[i];	m_hiY[j] = m_hiY[i];	m_hiZ[j] = m_hiZ[i];
+	m_freeX[j] = m_freeX[i];	m_freeY[j] = m_freeY[i];	m_freeZ[j] = m_freeZ[i];
+	m_nextChangeTime[j] = m_nextChangeTime[i];
+}
+
+void WorldMotionBatch::clearLane(int i) {
+	m_px[i] = m_py[i] = m_pz[i] = 0.0f;
+	m_vx[i] = m_vy[i] = m_vz[i] = 0.0f;
+	m_loX[i] = m_loY[i] = m_loZ[i] = 0.0f;
+	m_hiX[i] = m_hiY[i] = m_hiZ[i] = 0.0f;
+	m_freeX[i] = m_freeY[i] = m_freeZ[i] = 0.0f;
+	m_nextChangeTime[i] = finf();
+}
+
+void WorldMotionBatch::readEntity(int i) {
+	const FlyingEntity& t = *m_targets[i];
+	const Point3& p = t.frame().translation;
+	m_px[i] = p.x;		m_py[i] = p.y;		m_pz[i] = p.z;
+	m_vx[i] = t.m_velocity.x;	m_vy[i] = t.m_velocity.y;	m_vz[i] = t.m_velocity.z;
+	m_loX[i] = t.m_bounds.low().x;	m_loY[i] = t.m_bounds.low().y;	m_loZ[i] = t.m_bounds.low().z;
+	m_hiX[i] = t.m_bounds.high().x;	m_hiY[i] = t.m_bounds.high().y;	m_hiZ[i] = t.m_bounds.high().z;
+	m_freeX[i] = t.m_axisLocks[0] ? 0.0f : 1.0f;
+	m_freeY[i] = t.m_axisLocks[1] ? 0.0f : 1.0f;
+	m_freeZ[i] = t.m_axisLocks[2] ? 0.0f : 1.0f;
+	m_nextChangeTime[i] = t.m_nextChangeTime;
+}
+
+void WorldMotionBatch::add(const shared_ptr<FlyingEntity>& target) {
+	alwaysAssertM(target->motionBatchIndex() < 0, "Target is already in a motion batch!");
+	const int i = m_count++;
+	m_targets.append(target);
+	resizeLanes();
+	readEntity(i);
+	target->setMotionBatchIndex(i);
+}
+
+void WorldMotionBatch::remove(const shared_ptr<TargetEntity>& target) {
+	const int i = target->motionBatchIndex();
+	if (i < 0 || i >= m_count || m_targets[i] != target) return;
+
+	// Hand the motion state back to the entity
+	FlyingEntity& t = *m_targets[i];
+	t.m_velocity = Vector3(m_vx[i], m_vy[i], m_vz[i]);
+	t.m_nextChangeTime = m_nextChangeTime[i];
+	t.setMotionBatchIndex(-1);
+
+	// Swap the last target into this lane
+	const int last = m_count - 1;
+	if (i != last) {
+		moveLane(last, i);
+		m_targets[last]->setMotionBatchIndex(i);
+	}
+	m_targets.fastRemove(i);
+	m_count--;
+	resizeLanes();
+}
+
+void WorldMotionBatch::resync(const shared_ptr<TargetEntity>& target) {
+	const int i = target->motionBatchIndex();
+	if (i < 0 || i >= m_count || m_targets[i] != target) return;
+	readEntity(i);
+}
+
+void WorldMotionBatch::clear() {
+	for (const shared_ptr<FlyingEntity>& t : m_targets) {
+		t->setMotionBatchIndex(-1);
+	}
+	m_targets.fastClear();
+	m_count = 0;
+	resizeLanes();
+}
+
+void WorldMotionBatch::changeDirection(int i, SimTime absoluteTime) {
+	FlyingEntity& t = *m_targets[i];
+	CounterRandom& rng = t.m_rng;
+	const Point3 pos(m_px[i], m_py[i], m_pz[i]);
+	// Update the next change time
+	const float motionChangeTime = rng.uniform(t.m_motionChangePeriodRange[0], t.m_motionChangePeriodRange[1]);
+	m_nextChangeTime[i] = absoluteTime + motionChangeTime;
+	// Velocity to use for this next interval
+	const float vel = rng.uniform(t.m_angularSpeedRange[0], t.m_angularSpeedRange[1]);
+	Point3 destination = rng.randomInteriorPoint(t.m_bounds);
+	if (t.m_axisLocks[0]) destination.x = pos.x;
+	if (t.m_axisLocks[1]) destination.y = pos.y;
+	if (t.m_axisLocks[2]) destination.z = pos.z;
+	if (t.m_axisLocks[0] && t.m_axisLocks[1] && t.m_axisLocks[2] && vel > 0) {
+		throw "Cannot lock all axes for non-static target!";
+	}
+	const Vector3 v = vel * (destination - pos).direction();
+	m_vx[i] = v.x;	m_vy[i] = v.y;	m_vz[i] = v.z;
+	// Keep the entity's motion state current (for FlyingEntity::predictPosition)
+	t.m_velocity = v;
+	t.m_nextChangeTime = m_nextChangeTime[i];
+}
+
+// Per-lane select: mask ? a : b
+static inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Reflect a velocity component about the bounds (for a target outside them)
+static inline __m128 reflect(__m128 p, __m128 v, __m128 lo, __m128 hi) {
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 absV = _mm_andnot_ps(signBit, v);
+	const __m128 negAbsV = _mm_or_ps(signBit, v);
+	return select(_mm_cmpge_ps(p, hi), negAbsV, select(_mm_cmple_ps(p, lo), absV, v));
+}
+
+void WorldMotionBatch::simulate(SimTime absoluteTime, SimTime deltaTime) {
+	if (m_count == 0) return;
+	const int lanes = m_px.size();
+
+	// 1. Reflect the velocity of any target that has left its bounds
+	for (int i = 0; i < lanes; i += 4) {
+		const __m128 px = _mm_loadu_ps(&m_px[i]), py = _mm_loadu_ps(&m_py[i]), pz = _mm_loadu_ps(&m_pz[i]);
+		const __m128 vx = _mm_loadu_ps(&m_vx[i]), vy = _mm_loadu_ps(&m_vy[i]), vz = _mm_loadu_ps(&m_vz[i]);
+		const __m128 loX = _mm_loadu_ps(&m_loX[i]), loY = _mm_loadu_ps(&m_loY[i]), loZ = _mm_loadu_ps(&m_loZ[i]);
+		const __m128 hiX = _mm_loadu_ps(&m_hiX[i]), hiY = _mm_loadu_ps(&m_hiY[i]), hiZ = _mm_loadu_ps(&m_hiZ[i]);
+		const __m128 outside = _mm_or_ps(
+			_mm_or_ps(_mm_or_ps(_mm_cmplt_ps(px, loX), _mm_cmpgt_ps(px, hiX)), _mm_or_ps(_mm_cmplt_ps(py, loY), _mm_cmpgt_ps(py, hiY))),
+			_mm_or_ps(_mm_cmplt_ps(pz, loZ), _mm_cmpgt_ps(pz, hiZ)));
+		const int mask = _mm_movemask_ps(outside);
+		if (mask == 0) continue;
+		_mm_storeu_ps(&m_vx[i], select(outside, reflect(px, vx, loX, hiX), vx));
+		_mm_storeu_ps(&m_vy[i], select(outside, reflect(py, vy, loY, hiY), vy));
+		_mm_storeu_ps(&m_vz[i], select(outside, reflect(pz, vz, loZ, hiZ), vz));
+		for (int j = 0; j < 4; j++) {
+			if ((mask & (1 << j)) && i + j < m_count) {
+				m_targets[i + j]->m_velocity = Vector3(m_vx[i + j], m_vy[i + j], m_vz[i + j]);
+			}
+		}
+	}
+
+	// 2. Direction changes (these replace the velocity, so they take precedence over reflection)
+	for (int i = 0; i < m_count; i++) {
+		if (absoluteTime > m_nextChangeTime[i]) {
+			changeDirection(i, absoluteTime);
+		}
+	}
+
+	// 3. Integrate (locked axes don't move)
+	const __m128 dt = _mm_set1_ps(float(deltaTime));
+	for (int i = 0; i < lanes; i += 4) {
+		_mm_storeu_ps(&m_px[i], _mm_add_ps(_mm_loadu_ps(&m_px[i]), _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(&m_vx[i]), _mm_loadu_ps(&m_freeX[i])), dt)));
+		_mm_storeu_ps(&m_py[i], _mm_add_ps(_mm_loadu_ps(&m_py[i]), _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(&m_vy[i]), _mm_loadu_ps(&m_freeY[i])), dt)));
+		_mm_storeu_ps(&m_pz[i], _mm_add_ps(_mm_loadu_ps(&m_pz[i]), _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(&m_vz[i]), _mm_loadu_ps(&m_freeZ[i])), dt)));
+	}
+
+	// 4. Write the frames back
+	for (int i = 0; i < m_count; i++) {
+		m_targets[i]->setFrame(Point3(m_px[i], m_py[i], m_pz[i]));
+	}
+}
+
+void TargetWorkerPool::start(int threadCount) {
+	stop();
+	{
+		// Workers start at generation 0, so a restarted pool must not leave a previous generation (or job) behind
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_running = true;
+		m_generation = 0;
+		m_pending = 0;
+		m_error = nullptr;
+		m_targets = nullptr;
+	}
+	for (int i = 1; i < threadCount; i++) {
+		m_threads.push_back(std::thread(&TargetWorkerPool::threadEntry, this, i));
+	}
+}
+
+void TargetWorkerPool::stop() {
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_running = false;
+	}
+	m_startCV.notify_all();
+	for (std::thread& t : m_threads) {
+		t.join();
+	}
+	m_threads.clear();
+}
+
+void TargetWorkerPool::threadEntry(int partition) {
+	uint32 generation = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lk(m_mutex);
+			m_startCV.wait(lk, [&] { return !m_running || m_generation != generation; });
+			if (!m_running) return;
+			generation = m_generation;
+		}
+		simulatePartition(partition);
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			if (--m_pending == 0) m_doneCV.notify_one();
+		}
+	}
+}
+
+void TargetWorkerPool::simulatePartition(int partition) {
+	const int n = m_targets->size();
+	const int parts = threadCount();
+	const int begin = int(int64(n) * partition / parts);
+	const int end = int(int64(n) * (partition + 1) / parts);
+	try {
+		for (int i = begin; i < end; i++) {
+			(*m_targets)[i]->simulateMotion(m_absoluteTime, m_deltaTime);
+		}
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lk(m_mutex);
+		if (!m_error) m_error = std::current_exception();
+	}
+}
+
+void TargetWorkerPool::simulate(const Array<shared_ptr<TargetEntity>>& targets, SimTime absoluteTime, SimTime deltaTime) {
+	if (!enabled() || targets.size() < m_minTargetsPerThread * threadCount()) {
+		for (const shared_ptr<TargetEntity>& target : targets) {
+			target->simulateMotion(absoluteTime, deltaTime);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_targets = &targets;
+		m_absoluteTime = absoluteTime;
+		m_deltaTime = deltaTime;
+		m_pending = (int)m_threads.size();
+		m_generation++;
+	}
+	m_startCV.notify_all();
+	simulatePartition(0);
+
+	// Barrier: wait for all partitions before anyone reads the target frames
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lk(m_mutex);
+		m_doneCV.wait(lk, [&] { return m_pending == 0; });
+		m_targets = nullptr;
+		std::swap(error, m_error);
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+int TargetClock::advance(SimTime absoluteTime, SimTime deltaTime, const Array<shared_ptr<TargetEntity>>& targets, TargetWorkerPool& pool, WorldMotionBatch& batch) {
+	if (m_time < 0) m_time = absoluteTime - deltaTime;
+	m_accumulator = min(m_accumulator + deltaTime, m_maxLag);
+
+	// Frames hold interpolated (display) positions, restore the simulated ones first
+	for (const shared_ptr<TargetEntity>& target : targets) {
+		target->restoreStep();
+	}
+
+	int steps = 0;
+	while (m_accumulator >= m_step) {
+		m_time += m_step;
+		m_accumulator -= m_step;
+		for (const shared_ptr<TargetEntity>& target : targets) {
+			target->beginStep();
+		}
+		pool.simulate(targets, m_time, m_step);
+		batch.simulate(m_time, m_step);
+		steps++;
+	}
+
+	// Display positions between the last two steps
+	const float alpha = float(m_accumulator / m_step);
+	for (const shared_ptr<TargetEntity>& target : targets) {
+		target->endStep(alpha);
+	}
+	return steps;
+}
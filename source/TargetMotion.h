@@ -0,0 +1,113 @@
+#pragma once
+#include <G3D/G3D.h>
+#include <condition_variable>
+
+class TargetEntity;
+class FlyingEntity;
+
+/** Batched world-space motion for flying targets.
+	Positions, velocities, bounds and axis locks are kept in structure-of-arrays form and advanced 4 targets
+	at a time (SSE). Only the (infrequent) random direction changes are handled per target, and frames are
+	written back to the entities once per step. Motion matches FlyingEntity::onSimulation (same random draws). */
+class WorldMotionBatch {
+protected:
+	int m_count = 0;								///< Number of (live) targets in the batch
+	Array<shared_ptr<FlyingEntity>> m_targets;		///< Targets (index matches the lanes below)
+
+	// Per target lanes (padded to a multiple of 4, padding lanes are inert)
+	Array<float> m_px, m_py, m_pz;					///< Position
+	Array<float> m_vx, m_vy, m_vz;					///< Velocity
+	Array<float> m_loX, m_loY, m_loZ;				///< Move bounds (low)
+	Array<float> m_hiX, m_hiY, m_hiZ;				///< Move bounds (high)
+	Array<float> m_freeX, m_freeY, m_freeZ;			///< 0 for locked axes, 1 otherwise
+	Array<SimTime> m_nextChangeTime;				///< Time of the next direction change
+
+	/** Resize all lanes to hold m_count targets (rounded up to a multiple of 4) */
+	void resizeLanes();
+	/** Copy lane i to lane j */
+	void moveLane(int i, int j);
+	/** Zero lane i (so it never moves or reflects) */
+	void clearLane(int i);
+	/** Read the motion state of target i from its entity */
+	void readEntity(int i);
+	/** Pick a new destination/speed for target i (matches FlyingEntity::onSimulation) */
+	void changeDirection(int i, SimTime absoluteTime);
+
+public:
+	/** Add a world-space target to the batch (its current frame/motion state is captured) */
+	void add(const shared_ptr<FlyingEntity>& target);
+	/** Remove a target from the batch (its motion state is written back), no-op if it isn't batched */
+	void remove(const shared_ptr<TargetEntity>& target);
+	/** Re-read a target's state after it was moved/reset outside the batch (e.g. on respawn) */
+	void resync(const shared_ptr<TargetEntity>& target);
+	void clear();
+
+	/** Advance all targets to absoluteTime by deltaTime and write their frames */
+	void simulate(SimTime absoluteTime, SimTime deltaTime);
+
+	int size() const { return m_count; }
+};
+
+/** Persistent worker threads that advance target motion (TargetEntity::simulateMotion) in parallel.
+	Targets are split into fixed, contiguous partitions (the calling thread takes the first). Each target only
+	touches its own state and random stream, so results match the serial update for any thread count or
+	scheduling. simulate() returns once all partitions are done, so poses/rendering never see a partial step. */
+class TargetWorkerPool {
+protected:
+	std::vector<std::thread> m_threads;				///< Workers (partitions 1..n, the caller runs partition 0)
+	std::mutex m_mutex;
+	std::condition_variable m_startCV;				///< Signals a new generation (or shutdown) to the workers
+	std::condition_variable m_doneCV;				///< Signals the caller when the last worker finishes
+	bool m_running = false;
+	uint32 m_generation = 0;						///< Incremented for each simulate() call
+	int m_pending = 0;								///< Workers yet to finish the current generation
+	std::exception_ptr m_error;						///< First exception thrown by a partition (rethrown by the caller)
+
+	// Current job (only written while the workers are idle)
+	const Array<shared_ptr<TargetEntity>>* m_targets = nullptr;
+	SimTime m_absoluteTime = 0;
+	SimTime m_deltaTime = 0;
+
+	const int m_minTargetsPerThread = 2;			///< Fewer targets than this per thread are simulated serially
+
+	void threadEntry(int partition);
+	void simulatePartition(int partition);
+
+public:
+	TargetWorkerPool() {}
+	~TargetWorkerPool() { stop(); }
+
+	/** Start threadCount threads in total (including the caller), 1 or less simulates serially on the caller */
+	void start(int threadCount);
+	void stop();
+
+	bool enabled() const { return m_threads.size() > 0; }
+	int threadCount() const { return (int)m_threads.size() + 1; }
+
+	/** Call simulateMotion(absoluteTime, deltaTime) on all targets, returns once all are done */
+	void simulate(const Array<shared_ptr<TargetEntity>>& targets, SimTime absoluteTime, SimTime deltaTime);
+};
+
+/** Fixed-rate clock for target motion, decoupling motion fidelity/cost from the frame rate.
+	Targets are sub-stepped at the clock rate (w/ an accumulator) and their frames are interpolated
+	between the last two steps for display. */
+class TargetClock {
+protected:
+	SimTime m_step = 0;								///< Fixed step (s), 0 when disabled
+	SimTime m_time = -1;							///< Time of the latest step (negative until first advanced)
+	SimTime m_accumulator = 0;						///< Time not yet simulated
+	SimTime m_maxLag = 0.25;						///< Time beyond which unsimulated time is dropped (rather than sub-stepped)
+
+public:
+	/** Set the clock rate in Hz (0 disables the clock) */
+	void setRate(float rate) {
+		m_step = (rate > 0.0f) ? (SimTime)(1.0f / rate) : (SimTime)0;
+		m_time = -1;
+		m_accumulator = 0;
+	}
+
+	bool enabled() const { return m_step > 0; }
+
+	/** Advance by deltaTime (to absoluteTime), stepping targets (on the pool) and the batch at the fixed rate, returns the number of steps taken */
+	int advance(SimTime absoluteTime, SimTime deltaTime, const Array<shared_ptr<TargetEntity>>& targets, TargetWorkerPool& pool, WorldMotionBatch& batch);
+};
@@ -0,0 +1,35 @@
+#include "TargetPalette.h"
+
+shared_ptr<UniversalMaterial> TargetPalette::createMaterial(const Color3& color) {
+	UniversalMaterial::Specification materialSpecification;
+	materialSpecification.setLambertian(Texture::Specification(color));
+	materialSpecification.setEmissive(Texture::Specification(color * 0.7f));
+	materialSpecification.setGlossy(Texture::Specification(Color4(0.4f, 0.2f, 0.1f, 0.8f)));
+	return UniversalMaterial::create(materialSpecification);
+}
+
+shared_ptr<ArticulatedModel::Pose> TargetPalette::createPose(const Color3& color) {
+	const shared_ptr<ArticulatedModel::Pose>& amPose = ArticulatedModel::Pose::create();
+	amPose->materialTable.set("core/icosahedron_default", createMaterial(color));
+	return amPose;
+}
+
+void TargetPalette::build(const Array<Color3>& healthColors, int levels) {
+	if (matches(healthColors, levels)) return;
+	m_healthColors = healthColors;
+	m_levels = levels;
+	m_poses.fastClear();
+	for (int i = 0; i <= levels; i++) {
+		const float complete = (float)i / levels;
+		const Color3 color = healthColors[0] * complete + healthColors[1] * (1.0f - complete);
+		m_poses.append(createPose(color));
+	}
+}
+
+const shared_ptr<ArticulatedModel::Pose>& TargetPalette::pose(const Color3& color) {
+	const int idx = m_customColors.findIndex(color);
+	if (idx >= 0) return m_customPoses[idx];
+	m_customColors.append(color);
+	m_customPoses.append(createPose(color));
+	return m_customPoses.last();
+}
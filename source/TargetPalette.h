@@ -0,0 +1,37 @@
+#pragma once
+#include <G3D/G3D.h>
+
+/** Shared target materials and poses for the (quantized) target health colors.
+	The palette is built once (per set of health colors) and targets switch between its poses by index,
+	so spawning and hitting targets allocates no materials or poses. */
+class TargetPalette {
+protected:
+	Array<Color3>								m_healthColors;		///< Start/end (full/no health) colors the palette was built from
+	int											m_levels = 0;		///< Number of health levels (hit colors)
+	Array<shared_ptr<ArticulatedModel::Pose>>	m_poses;			///< Pose for each level (plus the full health color at m_levels)
+	Array<Color3>								m_customColors;		///< Other colors requested (e.g. reference targets)
+	Array<shared_ptr<ArticulatedModel::Pose>>	m_customPoses;		///< Poses for m_customColors
+
+public:
+	/** Material used for a target of this color */
+	static shared_ptr<UniversalMaterial> createMaterial(const Color3& color);
+	/** Pose applying the material for this color to the target model */
+	static shared_ptr<ArticulatedModel::Pose> createPose(const Color3& color);
+
+	/** Build levels health colors between healthColors[0] (full health) and healthColors[1] (no health) */
+	void build(const Array<Color3>& healthColors, int levels);
+	/** Is the palette built from these colors? */
+	bool matches(const Array<Color3>& healthColors, int levels) const {
+		return m_levels == levels && m_healthColors == healthColors;
+	}
+
+	int levels() const { return m_levels; }
+	/** Palette index for a health value in [0, 1] */
+	int healthIndex(float health) const { return min((int)(health * m_levels), m_levels - 1); }
+	/** Palette index for the (unquantized) full health color used at spawn */
+	int spawnIndex() const { return m_levels; }
+
+	const shared_ptr<ArticulatedModel::Pose>& pose(int index) const { return m_poses[index]; }
+	/** Shared pose for any other color (created on first use) */
+	const shared_ptr<ArticulatedModel::Pose>& pose(const Color3& color);
+};
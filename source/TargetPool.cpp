@@ -0,0 +1,11 @@
+#include "TargetPool.h"
+
+void TargetPool::release(const shared_ptr<TargetEntity>& target) {
+	if (target->id().empty()) return;
+	m_free.getCreate(key(target->id(), target->scaleIndex())).append(target);
+}
+
+int TargetPool::available(const String& configId, int scaleIdx) const {
+	const Array<shared_ptr<TargetEntity>>* free = m_free.getPointer(key(configId, scaleIdx));
+	return isNull(free) ? 0 : free->size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <G3D/G3D.h>
+#include "TargetEntity.h"
+
+/** Inactive targets kept for reuse across trials and respawns.
+	Targets are keyed by config ID and scale index (which together fix the target type and model),
+	so reusing one only requires resetting its motion state (see the TargetEntity::reinit() methods). */
+class TargetPool {
+protected:
+	Table<String, Array<shared_ptr<TargetEntity>>> m_free;		///< Inactive targets by key
+
+	static String key(const String& configId, int scaleIdx) {
+		return format("%s/%d", configId.c_str(), scaleIdx);
+	}
+
+public:
+	/** Get an inactive target for this config/scale index, returns null if none are available */
+	template <class T>
+	shared_ptr<T> acquire(const String& configId, int scaleIdx) {
+		Array<shared_ptr<TargetEntity>>* free = m_free.getPointer(key(configId, scaleIdx));
+		if (isNull(free) || free->size() == 0) return nullptr;
+		return dynamic_pointer_cast<T>(free->pop());
+	}
+
+	/** Return a (removed from scene) target to the pool, targets without a config ID are not pooled */
+	void release(const shared_ptr<TargetEntity>& target);
+
+	/** Number of inactive targets available for this config/scale index */
+	int available(const String& configId, int scaleIdx) const;
+
+	void clear() { m_free.clear(); }
+};
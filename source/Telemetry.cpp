@@ -0,0 +1,88 @@
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "Telemetry.h"
+#include "Session.h"
+
+#pragma comment(lib, "ws2_32.lib")
+
+TelemetryPublisher::TelemetryPublisher(int port) : m_port(port) {
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		logPrintf("Telemetry: WSAStartup failed, telemetry disabled\n");
+		return;
+	}
+	m_wsaStarted = true;
+
+	SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (s == INVALID_SOCKET) {
+		logPrintf("Telemetry: could not create socket, telemetry disabled\n");
+		return;
+	}
+
+	// Never block the frame loop on a slow (or absent) consumer
+	u_long nonBlocking = 1;
+	ioctlsocket(s, FIONBIO, &nonBlocking);
+
+	// Connect the datagram socket so each send goes straight to the loopback port
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((u_short)m_port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(s, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR) {
+		logPrintf("Telemetry: could not connect to port %d, telemetry disabled\n", m_port);
+		closesocket(s);
+		return;
+	}
+
+	m_socket = (uintptr_t)s;
+	logPrintf("Telemetry: publishing to 127.0.0.1:%d\n", m_port);
+}
+
+TelemetryPublisher::~TelemetryPublisher() {
+	if ((SOCKET)m_socket != INVALID_SOCKET) {
+		closesocket((SOCKET)m_socket);
+		logPrintf("Telemetry: closed after dropping %llu messages\n", m_dropped);
+	}
+	if (m_wsaStarted) WSACleanup();
+}
+
+void TelemetryPublisher::send(TelemetryHeader& header, TelemetryMessageType type, FILETIME time, int size) {
+	header.type = type;
+	header.sequence = m_sequence++;
+	header.time = (static_cast<uint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+
+	if ((SOCKET)m_socket == INVALID_SOCKET) {
+		m_dropped++;
+		return;
+	}
+	// Any failure (would block, no listener, etc.) simply drops this message
+	if (::send((SOCKET)m_socket, (const char*)&header, size, 0) != size) {
+		m_dropped++;
+	}
+}
+
+void TelemetryPublisher::publishFrame(FILETIME time, float rdt, float sdt, float idt, size_t loggerQueueBytes) {
+	TelemetryFrameMessage msg;
+	msg.rdt = rdt;
+	msg.sdt = sdt;
+	msg.idt = idt;
+	msg.loggerQueueBytes = (uint32)min(loggerQueueBytes, (size_t)UINT32_MAX);
+	send(msg.header, TelemetryFrame, time, sizeof(msg));
+}
+
+void TelemetryPublisher::publishPlayerAction(const PlayerAction& action) {
+	TelemetryActionMessage msg;
+	msg.action = (uint8)action.action;
+	msg.az = action.viewDirection.x;
+	msg.el = action.viewDirection.y;
+	send(msg.header, TelemetryAction, action.time, sizeof(msg));
+}
+
+void TelemetryPublisher::publishTrial(FILETIME time, int trialIdx, float taskExecutionTime, int destroyedTargets, int totalTargets) {
+	TelemetryTrialMessage msg;
+	msg.trialIdx = trialIdx;
+	msg.taskExecutionTime = taskExecutionTime;
+	msg.destroyedTargets = destroyedTargets;
+	msg.totalTargets = totalTargets;
+	send(msg.header, TelemetryTrial, time, sizeof(msg));
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <G3D/G3D.h>
+
+struct PlayerAction;
+
+/** Message types sent by the telemetry publisher */
+enum TelemetryMessageType : uint8 {
+	TelemetryFrame = 1,
+	TelemetryAction = 2,
+	TelemetryTrial = 3
+};
+
+#pragma pack(push, 1)
+/** Common header prefixed to every telemetry message (little endian) */
+struct TelemetryHeader {
+	uint16 magic = 0x5446;				///< 'FT' marker used to reject stray datagrams
+	uint8 version = 1;					///< Message format version
+	uint8 type = 0;						///< TelemetryMessageType
+	uint32 sequence = 0;				///< Per-publisher sequence number (gaps indicate drops)
+	uint64 time = 0;					///< FILETIME of the sample (100ns ticks since 1601)
+};
+
+struct TelemetryFrameMessage {
+	TelemetryHeader header;
+	float rdt = 0.0f;					///< Real delta time (s)
+	float sdt = 0.0f;					///< Simulation delta time (s)
+	float idt = 0.0f;					///< Ideal delta time (s)
+	uint32 loggerQueueBytes = 0;		///< Bytes pending in the logger queues
+};
+
+struct TelemetryActionMessage {
+	TelemetryHeader header;
+	uint8 action = 0;					///< PlayerActionType
+	float az = 0.0f;					///< View azimuth (deg)
+	float el = 0.0f;					///< View elevation (deg)
+};
+
+struct TelemetryTrialMessage {
+	TelemetryHeader header;
+	int32 trialIdx = 0;					///< Trial index within the session
+	float taskExecutionTime = 0.0f;		///< Task execution time (s)
+	int32 destroyedTargets = 0;			///< Destroyed target count
+	int32 totalTargets = 0;				///< Total target count (-1 for infinite respawn)
+};
+#pragma pack(pop)
+
+/** Publishes compact binary telemetry datagrams to a loopback port for live monitoring.
+	Sends never block, messages are dropped whenever the socket cannot accept them immediately. */
+class TelemetryPublisher : public ReferenceCountedObject {
+protected:
+	bool m_wsaStarted = false;				///< WSAStartup succeeded (so WSACleanup is owed)
+	uintptr_t m_socket = ~uintptr_t(0);		///< Winsock SOCKET handle (INVALID_SOCKET when closed)
+	int m_port;								///< Loopback port to publish to
+	uint32 m_sequence = 0;					///< Next message sequence number
+	uint64 m_dropped = 0;					///< Count of messages that could not be sent
+
+	void send(TelemetryHeader& header, TelemetryMessageType type, FILETIME time, int size);
+
+public:
+	TelemetryPublisher(int port);
+	virtual ~TelemetryPublisher();
+
+	static shared_ptr<TelemetryPublisher> create(int port) {
+		return createShared<TelemetryPublisher>(port);
+	}
+
+	void publishFrame(FILETIME time, float rdt, float sdt, float idt, size_t loggerQueueBytes);
+	void publishPlayerAction(const PlayerAction& action);
+	void publishTrial(FILETIME time, int trialIdx, float taskExecutionTime, int destroyedTargets, int totalTargets);
+
+	uint64 droppedCount() const { return m_dropped; }
+};
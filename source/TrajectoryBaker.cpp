@@ -0,0 +1,88 @@
+#include "TrajectoryBaker.h"
+#include "ConfigFiles.h"
+
+Array<Destination> TrajectoryBaker::bake(
+	shared_ptr<const TargetConfig>	config,
+	const Point3&					start,
+	const Point3&					orbitCenter,
+	float							targetDistance,
+	int								paramIdx,
+	const CounterRandom&			rng,
+	SimTime							duration,
+	float							tolerance)
+{
+	alwaysAssertM(config->bakeRate > 0.0f, "Can't bake a target trajectory w/ a non-positive rate!");
+	const bool isWorldSpace = config->destSpace == "world";
+
+	// Same setup as a live target (no scene or model, motion only)
+	shared_ptr<TargetEntity> target;
+	if (config->jumpEnabled) {
+		shared_ptr<JumpingEntity> t = JumpingEntity::create(config, config->id, nullptr, nullptr, 0, orbitCenter, targetDistance, paramIdx, rng);
+		t->setWorldSpace(isWorldSpace);
+		if (isWorldSpace) t->setMoveBounds(config->moveBounds);
+		target = t;
+	}
+	else {
+		shared_ptr<FlyingEntity> t = FlyingEntity::create(config, config->id, nullptr, nullptr, orbitCenter, 0, paramIdx, rng);
+		t->setWorldSpace(isWorldSpace);
+		if (isWorldSpace) t->setBounds(config->moveBounds);
+		target = t;
+	}
+	target->setFrame(start);
+
+	// Simulate at the (fixed) bake rate
+	const SimTime dt = 1.0f / config->bakeRate;
+	const int steps = max(1, iCeil(duration * config->bakeRate));
+	Array<Destination> path;
+	path.reserve(steps + 1);
+	path.append(Destination(start, 0.0f));
+	for (int i = 1; i <= steps; i++) {
+		const SimTime t = i * dt;
+		target->onSimulation(t, dt);
+		path.append(Destination(target->frame().translation, t));
+	}
+
+	decimate(path, tolerance);
+	return path;
+}
+
+void TrajectoryBaker::decimate(Array<Destination>& path, float tolerance) {
+	const int n = path.size();
+	if (n < 3) return;
+
+	Array<bool> keep;
+	keep.resize(n);
+	for (int i = 0; i < n; i++) keep[i] = false;
+	keep[0] = keep[n - 1] = true;
+
+	// Split each span at its worst sample until every sample is within tolerance
+	Array<Vector2int32> spans;
+	spans.append(Vector2int32(0, n - 1));
+	while (spans.size() > 0) {
+		const Vector2int32 span = spans.pop();
+		const Destination& a = path[span.x];
+		const Destination& b = path[span.y];
+		const SimTime duration = b.time - a.time;
+		float maxError = 0.0f;
+		int worst = -1;
+		for (int i = span.x + 1; i < span.y; i++) {
+			const float prog = (duration > 0) ? float((path[i].time - a.time) / duration) : 0.0f;
+			const float error = (path[i].position - (a.position + prog * (b.position - a.position))).length();
+			if (error > maxError) {
+				maxError = error;
+				worst = i;
+			}
+		}
+		if (maxError > tolerance) {
+			keep[worst] = true;
+			spans.append(Vector2int32(span.x, worst));
+			spans.append(Vector2int32(worst, span.y));
+		}
+	}
+
+	int count = 0;
+	for (int i = 0; i < n; i++) {
+		if (keep[i]) path[count++] = path[i];
+	}
+	path.resize(count);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <G3D/G3D.h>
+#include "TargetEntity.h"
+
+/** Pre-simulates parametric (flying/jumping) target motion at a fixed rate and reduces it to a compact
+	keyframe path, which plays back through TargetEntity's destination (path) code at runtime. */
+class TrajectoryBaker {
+public:
+	/** Simulate a target (w/ its own random stream) from start for duration seconds at config->bakeRate.
+		Player space targets are baked about an orbit center at orbitCenter (their path is offset at spawn).
+		Keyframes that linear interpolation reproduces to within tolerance (m) are dropped. */
+	static Array<Destination> bake(
+		shared_ptr<const TargetConfig>	config,
+		const Point3&					start,
+		const Point3&					orbitCenter,
+		float							targetDistance,
+		int								paramIdx,
+		const CounterRandom&			rng,
+		SimTime							duration,
+		float							tolerance = 0.001f);
+
+	/** Remove keyframes that linear interpolation (in time) reproduces to within tolerance (Ramer-Douglas-Peucker) */
+	static void decimate(Array<Destination>& path, float tolerance);
+};
@@ -0,0 +1,88 @@
+#include "TrialPlan.h"
+#include "ConfigFiles.h"
+
+void TrialPlan::init(const Array<Array<shared_ptr<const TargetConfig>>>& targetConfigs, const Array<int>& trialCounts, uint32 seed, int modelScaleCount) {
+	m_targetConfigs = targetConfigs;
+	m_remaining = trialCounts;
+	m_seed = seed;
+	m_sessionRng = CounterRandom(seed, 0);
+	m_modelScaleCount = modelScaleCount;
+	m_trials.fastClear();
+}
+
+bool TrialPlan::isFinite() const {
+	for (int remaining : m_remaining) {
+		if (remaining < 0) return false;
+	}
+	return true;
+}
+
+int TrialPlan::compileAll() {
+	alwaysAssertM(isFinite(), "Cannot plan all trials for a session w/ infinite trials!");
+	int total = m_trials.size();
+	for (int remaining : m_remaining) total += remaining;
+	return compile(total);
+}
+
+int TrialPlan::compile(int trialCount) {
+	Array<int> unrunTrialIdxs;
+	while (m_trials.size() < trialCount) {
+		// Choose the next condition (uniformly from those w/ trials remaining)
+		unrunTrialIdxs.fastClear();
+		for (int i = 0; i < m_remaining.size(); i++) {
+			if (m_remaining[i] > 0 || m_remaining[i] == -1) {
+				unrunTrialIdxs.append(i);
+			}
+		}
+		if (unrunTrialIdxs.size() == 0) break;
+		const int trialIdx = unrunTrialIdxs[m_sessionRng.integer(0, unrunTrialIdxs.size() - 1)];
+		if (m_remaining[trialIdx] > 0) {
+			m_remaining[trialIdx] -= 1;
+		}
+
+		// Sample its targets
+		PlannedTrial& trial = m_trials.next();
+		trial.trialIdx = trialIdx;
+		const int trialNumber = m_trials.size() - 1;
+		for (int i = 0; i < m_targetConfigs[trialIdx].size(); i++) {
+			trial.targets.append(sampleTarget(m_targetConfigs[trialIdx][i], trialNumber, i));
+		}
+	}
+	return m_trials.size();
+}
+
+PlannedTarget TrialPlan::sampleTarget(const shared_ptr<const TargetConfig>& config, int trialNumber, int paramIdx) const {
+	// Draw in the same order the targets consume their streams at spawn time
+	CounterRandom rng(m_seed, CounterRandom::targetStream(trialNumber, paramIdx));
+	PlannedTarget t;
+	t.id = config->id;
+	t.pitch = rng.sign() * rng.uniform(config->eccV[0], config->eccV[1]);
+	t.yaw = rng.sign() * rng.uniform(config->eccH[0], config->eccH[1]);
+	if (config->destSpace == "world" && config->destinations.size() == 0) {
+		t.spawnPos = rng.randomInteriorPoint(config->spawnBounds);
+	}
+	t.size = rng.uniform(config->size[0], config->size[1]);
+	t.scaleIdx = clamp(iRound(log(t.size) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_modelScaleCount - 1);
+	t.rngCounter = rng.counter();
+	return t;
+}
+
+void TrialPlan::save(const String& filename, int first) const {
+	FILE* f = FileSystem::fopen(filename.c_str(), (first > 0) ? "a" : "w");
+	if (isNull(f)) {
+		logPrintf("Could not write trial plan to %s\n", filename.c_str());
+		return;
+	}
+	if (first == 0) {
+		fprintf(f, "trial_number,trial_id,target_idx,target_id,pitch,yaw,spawn_x,spawn_y,spawn_z,size,scale_idx,rng_counter\n");
+	}
+	for (int n = first; n < m_trials.size(); n++) {
+		const PlannedTrial& trial = m_trials[n];
+		for (int i = 0; i < trial.targets.size(); i++) {
+			const PlannedTarget& t = trial.targets[i];
+			fprintf(f, "%d,%d,%d,%s,%f,%f,%f,%f,%f,%f,%d,%u\n", n, trial.trialIdx, i, t.id.c_str(),
+				t.pitch, t.yaw, t.spawnPos.x, t.spawnPos.y, t.spawnPos.z, t.size, t.scaleIdx, t.rngCounter);
+		}
+	}
+	FileSystem::fclose(f);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <G3D/G3D.h>
+#include "CounterRandom.h"
+
+class TargetConfig;
+
+/** Pre-sampled spawn parameters for a single target */
+struct PlannedTarget {
+	String	id;								///< Target config ID
+	float	pitch = 0.0f;					///< Spawn pitch (deg, player space)
+	float	yaw = 0.0f;						///< Spawn yaw (deg, player space)
+	Point3	spawnPos = Point3::zero();		///< Spawn position (world space targets only)
+	float	size = 0.0f;					///< Target size
+	int		scaleIdx = 0;					///< Model scale index for this size
+	uint32	rngCounter = 0;					///< Position in the target's random stream after these draws
+};
+
+/** A single planned trial (condition + targets) */
+struct PlannedTrial {
+	int		trialIdx = -1;					///< Index of the condition (into the session's trials)
+	Array<PlannedTarget> targets;			///< Sampled parameters for each target (by parameter index)
+};
+
+/** Expands a session's trial list into a flat, ordered schedule of conditions and sampled target parameters.
+	The plan is a pure function of the target configs, trial counts and seed (using the same random streams as the
+	session), so a session can be replayed exactly by re-running it with the logged seed. Sessions w/ infinite
+	trials are planned incrementally (see compile()). */
+class TrialPlan {
+protected:
+	Array<Array<shared_ptr<const TargetConfig>>>	m_targetConfigs;		///< Target configs by trial
+	Array<int>										m_remaining;			///< Remaining trials per condition (compiler state)
+	uint32											m_seed = 0;				///< Session seed
+	CounterRandom									m_sessionRng;			///< Session random stream (trial ordering)
+	int												m_modelScaleCount = 1;	///< Number of model scales available
+	Array<PlannedTrial>								m_trials;				///< The planned trials (in order)
+
+	PlannedTarget sampleTarget(const shared_ptr<const TargetConfig>& config, int trialNumber, int paramIdx) const;
+
+public:
+	TrialPlan() {}
+
+	/** Reset the plan for a set of target configs/trial counts (-1 for infinite) and seed */
+	void init(const Array<Array<shared_ptr<const TargetConfig>>>& targetConfigs, const Array<int>& trialCounts, uint32 seed, int modelScaleCount);
+
+	/** Plan trials until there are (at least) trialCount or the session is out of trials, returns the number of planned trials */
+	int compile(int trialCount);
+
+	/** Plan every remaining trial (only valid for sessions w/o infinite trials) */
+	int compileAll();
+
+	/** Returns true if all trials are finite (i.e. the whole session can be planned up front) */
+	bool isFinite() const;
+
+	int size() const { return m_trials.size(); }
+	bool contains(int trialNumber) const { return trialNumber >= 0 && trialNumber < m_trials.size(); }
+	const PlannedTrial& operator[](int trialNumber) const { return m_trials[trialNumber]; }
+
+	/** Write trials [first, size()) to a CSV file (one row per target) */
+	void save(const String& filename, int first = 0) const;
+};
@@ -194,11 +194,11 @@ shared_ptr<TargetEntity> WaypointManager::spawnDestTargetPreview(
 	// Create the target
 	const String nameStr = name.empty() ? format("destPreview") : name;
 	const int scaleIndex = clamp(iRound(log(size) / log(1.0f + TARGET_MODEL_ARRAY_SCALING) + TARGET_MODEL_ARRAY_OFFSET), 0, m_app->modelScaleCount - 1);
-	const shared_ptr<TargetEntity>& target = TargetEntity::create(dests, nameStr, m_scene, m_app->targetModels[id][scaleIndex], scaleIndex, 0);
+	const shared_ptr<TargetEntity>& target = TargetEntity::create(dests, nameStr, m_scene, m_app->targetModels.model(id, scaleIndex), scaleIndex, 0);
 
 	// Setup (additional) target parameters
 	target->setFrame(dests[0].position);
-	target->setColor(color);
+	target->setPalettePose(m_app->targetPalette.pose(color));
 
 	// Add target to array and scene
 	m_scene->insert(target);
@@ -1,6 +1,7 @@
 #pragma once
 #include <G3D/G3D.h>
 #include "ConfigFiles.h"
+#include "ModelCache.h"
 
 class Projectile : public Entity {
 public:
@@ -78,7 +79,7 @@ public:
 	void loadModels() {
 		// Create the view model
 		if (m_config->modelSpec.filename != "") {
-			m_viewModel = ArticulatedModel::create(m_config->modelSpec, "viewModel");
+			m_viewModel = ModelCache::common().get(m_config->modelSpec.toAny(), "viewModel");
 		}
 		else {
 			const static Any modelSpec = PARSE_ANY(ArticulatedModel::Specification{
@@ -89,7 +90,7 @@ public:
 				};
 				scale = 0.25;
 				});
-			m_viewModel = ArticulatedModel::create(modelSpec, "viewModel");
+			m_viewModel = ModelCache::common().get(modelSpec, "viewModel");
 		}
 
 		// Create the bullet model
@@ -108,7 +109,7 @@ public:
 				};\
 			}", 
 			scale.x, scale.y, scale.z, color.r, color.g, color.b));
-		m_bulletModel = ArticulatedModel::create(bulletSpec, "bulletModel");
+		m_bulletModel = ModelCache::common().get(bulletSpec, "bulletModel");
 	}
 
 	void loadSounds() {